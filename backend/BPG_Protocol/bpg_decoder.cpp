@@ -1,4 +1,7 @@
 #include "bpg_decoder.h"
+#include "bpg_logging.h"
+#include "bpg_latency.h"
+#include "hybrid_data_pool.h"
 #include <cstring> // For memcpy, memcmp
 #include <arpa/inet.h> // For ntohl, htonl (assuming network byte order)
 #include <iostream> // For potential debug output
@@ -11,22 +14,23 @@ namespace BPG {
 
 // --- Forward Declarations for new helpers ---
 static bool parseHeaderFromBuffer(const uint8_t* buffer_start, size_t buffer_len, PacketHeader& out_header);
-static BpgError parseDataFromBuffer(const PacketHeader& header, const uint8_t* data_start, HybridData& out_data);
+static BpgError parseDataFromBuffer(const PacketHeader& header, const uint8_t* data_start, HybridData& out_data,
+                                    bool copy_payload);
 // ---
 
-BpgDecoder::BpgDecoder() = default;
+BpgDecoder::BpgDecoder(size_t reassembly_capacity)
+    : internal_buffer_(reassembly_capacity) {}
 
 void BpgDecoder::reset() {
     internal_buffer_.clear();
     active_groups_.clear();
-    std::cout << "BPG Decoder reset." << std::endl;
+    BPG_LOGD("BPG Decoder reset.");
 }
 
 // --- Helper: Parse Header from contiguous buffer --- Updated for 18 bytes, new order
 static bool parseHeaderFromBuffer(const uint8_t* buffer_start, size_t buffer_len, PacketHeader& out_header) {
     if (!buffer_start || buffer_len < BPG_HEADER_SIZE) {
-        std::cerr << "[BPG Decode ERR] parseHeaderFromBuffer called with invalid args: buffer_start="
-                  << (void*)buffer_start << ", buffer_len=" << buffer_len << " (expected >= " << BPG_HEADER_SIZE << ")" << std::endl;
+        BPG_LOGE("[BPG Decode ERR] parseHeaderFromBuffer called with invalid args: buffer_start=" << (void*)buffer_start << ", buffer_len=" << buffer_len << " (expected >= " << BPG_HEADER_SIZE << ")");
         return false;
     }
 
@@ -52,9 +56,14 @@ static bool parseHeaderFromBuffer(const uint8_t* buffer_start, size_t buffer_len
 }
 
 // --- New Helper: Parse Data from contiguous buffer ---
-static BpgError parseDataFromBuffer(const PacketHeader& header, const uint8_t* data_start, HybridData& out_data) {
+// When copy_payload is false the binary payload is exposed as a non-owning
+// view into data_start (zero-copy fast path) instead of being copied into
+// internal_binary_bytes. The caller is responsible for materializing the view
+// if the packet has to outlive the buffer.
+static BpgError parseDataFromBuffer(const PacketHeader& header, const uint8_t* data_start, HybridData& out_data,
+                                    bool copy_payload) {
      if (!data_start) {
-         std::cerr << "[BPG Decode ERR] parseDataFromBuffer called with null data_start for TL: " << std::string(header.tl, 2) << std::endl;
+         BPG_LOGE("[BPG Decode ERR] parseDataFromBuffer called with null data_start for TL: " << std::string(header.tl, 2));
          return BpgError::DecodingError; 
      }
 
@@ -63,9 +72,7 @@ static BpgError parseDataFromBuffer(const PacketHeader& header, const uint8_t* d
     // Check required size for string length field
     constexpr size_t STR_LENGTH_SIZE = sizeof(uint32_t);
     if (header.data_length < STR_LENGTH_SIZE) {
-        std::cerr << "[BPG Decode ERR] HdrDataLen (" << header.data_length
-                  << ") < StrLenSize (" << STR_LENGTH_SIZE << ") for TL: "
-                  << std::string(header.tl, 2) << std::endl;
+        BPG_LOGE("[BPG Decode ERR] HdrDataLen (" << header.data_length << ") < StrLenSize (" << STR_LENGTH_SIZE << ") for TL: " << std::string(header.tl, 2));
         return BpgError::DecodingError;
     }
 
@@ -74,7 +81,7 @@ static BpgError parseDataFromBuffer(const PacketHeader& header, const uint8_t* d
     // 1. Read string length
     uint32_t str_len_n;
     if (current_ptr + STR_LENGTH_SIZE > data_end) { 
-         std::cerr << "[BPG Decode ERR] Incomplete data reading str length for TL: " << std::string(header.tl, 2) << std::endl;
+         BPG_LOGE("[BPG Decode ERR] Incomplete data reading str length for TL: " << std::string(header.tl, 2));
          return BpgError::IncompletePacket;
     }
     std::memcpy(&str_len_n, current_ptr, STR_LENGTH_SIZE);
@@ -83,19 +90,18 @@ static BpgError parseDataFromBuffer(const PacketHeader& header, const uint8_t* d
 
      // Verify consistency check
     if (STR_LENGTH_SIZE + str_len > header.data_length) {
-        std::cerr << "[BPG Decode ERR] StrLen+Hdr (" << (STR_LENGTH_SIZE + str_len)
-                  << ") > HdrDataLen (" << header.data_length
-                  << ") | str_len_n=0x" << std::hex << str_len_n << std::dec
-                  << ", str_len=" << str_len
-                  << ", TL: " << std::string(header.tl, 2) << std::endl;
+        BPG_LOGE("[BPG Decode ERR] StrLen+Hdr (" << (STR_LENGTH_SIZE + str_len) << ") > HdrDataLen (" << header.data_length << ") | str_len_n=0x" << std::hex << str_len_n << std::dec << ", str_len=" << str_len << ", TL: " << std::string(header.tl, 2));
         return BpgError::DecodingError;
     }
 
-    // 2. Read metadata string
+    // 2. Read metadata string (JSON by default; raw TLV bytes when the
+    // header's prop field carries BPG_PROP_TLV_META_BIT_MASK - see
+    // tlv_metadata.h for the reader)
     out_data.metadata_str.clear();
+    out_data.metadata_is_tlv = (header.prop & BPG_PROP_TLV_META_BIT_MASK) != 0;
     if (str_len > 0) {
         if (current_ptr + str_len > data_end) {
-             std::cerr << "[BPG Decode ERR] Incomplete metadata string data for TL: " << std::string(header.tl, 2) << std::endl;
+             BPG_LOGE("[BPG Decode ERR] Incomplete metadata string data for TL: " << std::string(header.tl, 2));
              return BpgError::IncompletePacket;
         }
         out_data.metadata_str.assign(reinterpret_cast<const char*>(current_ptr), str_len);
@@ -104,115 +110,184 @@ static BpgError parseDataFromBuffer(const PacketHeader& header, const uint8_t* d
 
     // 3. Read remaining binary bytes
     out_data.internal_binary_bytes.clear();
+    out_data.binary_view = nullptr;
+    out_data.binary_view_size = 0;
     size_t binary_bytes_len = header.data_length - STR_LENGTH_SIZE - str_len;
      if (binary_bytes_len > 0) {
         if (current_ptr + binary_bytes_len > data_end) {
-            std::cerr << "[BPG Decode ERR] Incomplete Binary data for TL: " << std::string(header.tl, 2) << std::endl;
+            BPG_LOGE("[BPG Decode ERR] Incomplete Binary data for TL: " << std::string(header.tl, 2));
              return BpgError::IncompletePacket;
         }
-        out_data.internal_binary_bytes.assign(current_ptr, current_ptr + binary_bytes_len);
+        if (copy_payload) {
+            out_data.internal_binary_bytes.assign(current_ptr, current_ptr + binary_bytes_len);
+        } else {
+            out_data.binary_view = current_ptr;
+            out_data.binary_view_size = binary_bytes_len;
+        }
     }
 
     return BpgError::Success;
 }
 
-// --- Refactored tryParsePacket ---
-bool BpgDecoder::tryParsePacket(std::deque<uint8_t>& buffer,
+// --- Refactored tryParsePacket (ring buffer version) ---
+bool BpgDecoder::tryParsePacket(ByteRingBuffer& buffer,
                             const AppPacketCallback& packet_callback,
                             const AppPacketGroupCallback& group_callback) {
-    // --- Step 1: Check if enough data for header using constant size --- 
+    // --- Step 1: Check if enough data for header using constant size ---
     if (buffer.size() < BPG_HEADER_SIZE) { // Use constant
         return false; // Not enough data yet
     }
 
-    // --- Step 2: Peek at header to get data_length --- 
-    // Copy exactly BPG_HEADER_SIZE bytes for peeking
-    uint8_t header_peek_bytes[BPG_HEADER_SIZE]; // Use constant
-    std::copy_n(buffer.begin(), BPG_HEADER_SIZE, header_peek_bytes); // Use constant
-    PacketHeader peek_header;
-    // Pass BPG_HEADER_SIZE as the length we copied
-    if (!parseHeaderFromBuffer(header_peek_bytes, BPG_HEADER_SIZE, peek_header)) { 
-         std::cerr << "[BPG Decode ERR] Header peek failed during parseHeaderFromBuffer." << std::endl;
-         reset(); 
-         return false; 
+    // --- Step 2: Peek at header to get data_length ---
+    // peekContiguous avoids the old header staging copy unless the header
+    // happens to wrap around the end of the ring.
+    PacketHeader header;
+    const uint8_t* header_bytes = buffer.peekContiguous(BPG_HEADER_SIZE);
+    if (!parseHeaderFromBuffer(header_bytes, BPG_HEADER_SIZE, header)) {
+         BPG_LOGE("[BPG Decode ERR] Header peek failed during parseHeaderFromBuffer.");
+         reset();
+         return false;
     }
-    uint32_t data_length = peek_header.data_length;
     // Calculate total size using the constant
-    size_t total_packet_size = BPG_HEADER_SIZE + data_length; 
-    
-    // --- Step 3: Check if enough data for the *entire* packet --- 
+    size_t total_packet_size = BPG_HEADER_SIZE + header.data_length;
+
+    // --- Step 3: Check if enough data for the *entire* packet ---
     if (buffer.size() < total_packet_size) {
         return false; // Not enough data yet
     }
 
-    // --- Step 4: Copy the full potential packet data to a contiguous buffer --- 
-    std::vector<uint8_t> temp_packet_buffer(total_packet_size);
-    std::copy_n(buffer.begin(), total_packet_size, temp_packet_buffer.begin());
+    // --- Step 4: Get a contiguous view of the full packet ---
+    // Direct pointer into the ring when unwrapped; linearized into the ring's
+    // scratch buffer (a single memcpy) only when the packet wraps.
+    const uint8_t* packet_bytes = buffer.peekContiguous(total_packet_size);
 
-    // --- Step 5: Parse Header and Data from the contiguous buffer --- 
-    PacketHeader header; 
-    HybridData hybrid_data; 
+    // --- Step 5: Parse Data (payload is copied; the ring is reused) ---
+    // Pooled content object: its internal_binary_bytes keeps its capacity
+    // across reuse, so the payload copy below rarely allocates.
+    std::shared_ptr<HybridData> hybrid_data = hybridDataPool().acquire();
+    BpgError data_err = parseDataFromBuffer(header, packet_bytes + BPG_HEADER_SIZE, *hybrid_data,
+                                            true /* copy_payload */);
 
-    // Parse header from temp buffer, passing its actual size
-    if (!parseHeaderFromBuffer(temp_packet_buffer.data(), temp_packet_buffer.size(), header)) {
-         std::cerr << "[BPG Decode ERR] Header parse failed on temp buffer." << std::endl;
-         buffer.erase(buffer.begin(), buffer.begin() + total_packet_size);
-         return true; 
-    }
-    if (header.data_length != data_length) {
-         std::cerr << "[BPG Decode ERR] Peeked data length (" << data_length 
-                   << ") != Parsed data length (" << header.data_length << "). Corrupted header? Discarding." << std::endl;
-         buffer.erase(buffer.begin(), buffer.begin() + total_packet_size);
-         return true;
+    // --- Step 6: Consume the packet from the ring ---
+    buffer.consume(total_packet_size);
+
+    // --- Step 7: Process the successfully parsed packet (if applicable) ---
+    if (data_err == BpgError::Success) {
+        dispatchParsedPacket(header, std::move(hybrid_data), false /* payload_is_view */,
+                             packet_callback, group_callback);
+    } else {
+        BPG_LOGE("BPG Decoder: Error deserializing app data for packet type " << std::string(header.tl, 2) << " (Error code: " << static_cast<int>(data_err) << ")");
     }
 
-    // Parse data from temp buffer (pointing after the fixed header size)
-    BpgError data_err = parseDataFromBuffer(header, temp_packet_buffer.data() + BPG_HEADER_SIZE, hybrid_data);
+    return true;
+}
 
-    // --- Step 6: Consume data from the main deque buffer --- 
-    buffer.erase(buffer.begin(), buffer.begin() + total_packet_size);
+// --- Shared packet dispatch (group bookkeeping + callbacks) ---
+void BpgDecoder::dispatchParsedPacket(const PacketHeader& header,
+                                      std::shared_ptr<HybridData>&& hybrid_data,
+                                      bool payload_is_view,
+                                      const AppPacketCallback& packet_callback,
+                                      const AppPacketGroupCallback& group_callback) {
+    // Check the EG bit from the uint32_t prop field
+    bool is_end = (header.prop & BPG_PROP_EG_BIT_MASK) != 0;
+
+    AppPacket app_packet;
+    app_packet.group_id = header.group_id;
+    app_packet.target_id = header.target_id;
+    std::memcpy(app_packet.tl, header.tl, sizeof(PacketType));
+    app_packet.is_end_of_group = is_end;
+
+    app_packet.content = std::move(hybrid_data);
+
+    // --- Streaming sinks: deliver immediately, skip group buffering ---
+    // A matching packet reaches its sink the moment it completes instead of
+    // sitting in active_groups_ until the EG bit arrives; its payload view
+    // stays valid for the duration of the sink call only.
+    if (!streaming_sinks_.empty()) {
+        auto sink_it = streaming_sinks_.find(sinkKey(header.group_id, header.tl));
+        if (sink_it != streaming_sinks_.end()) {
+            try { sink_it->second(app_packet); } catch(const std::exception& e) {
+                BPG_LOGE("[BPG ERR] Exception in streaming sink: " << e.what());
+            } catch(...) { BPG_LOGE("[BPG ERR] Unknown exception in streaming sink"); }
+            // The EG packet streamed - flush whatever NON-matching packets
+            // were buffered for this group through the normal path.
+            if (is_end && group_callback) {
+                AppPacketGroup group;
+                if (active_groups_.take(header.group_id, group)) {
+                    try { group_callback(header.group_id, std::move(group)); } catch(const std::exception& e) {
+                        BPG_LOGE("[BPG ERR] Exception in group_callback: " << e.what());
+                    } catch(...) { BPG_LOGE("[BPG ERR] Unknown exception in group_callback"); }
+                    active_groups_.recycle(std::move(group));
+                }
+            }
+            return;
+        }
+    }
 
-    // --- Step 7: Process the successfully parsed packet (if applicable) --- 
-    if (data_err == BpgError::Success) {
-        // Check the EG bit from the uint32_t prop field
-        bool is_end = (header.prop & BPG_PROP_EG_BIT_MASK) != 0;
+    const AppPacket* stored_packet = active_groups_.append(header.group_id, std::move(app_packet));
+    if (!stored_packet) {
+        BPG_LOGE("[BPG ERR] Packet for group " << header.group_id
+                 << " exceeds the reassembly byte cap, dropped.");
+        return;
+    }
 
-        AppPacket app_packet;
-        app_packet.group_id = header.group_id;
-        app_packet.target_id = header.target_id;
-        std::memcpy(app_packet.tl, header.tl, sizeof(PacketType));
-        app_packet.is_end_of_group = is_end;
+    if (packet_callback) {
+        try { packet_callback(*stored_packet); } catch(const std::exception& e) {
+             BPG_LOGE("[BPG ERR] Exception in packet_callback: " << e.what());
+         } catch(...) { BPG_LOGE("[BPG ERR] Unknown exception in packet_callback"); }
+    }
 
-        app_packet.content = std::make_shared<HybridData>(std::move(hybrid_data));
+    if (is_end && group_callback) {
+        AppPacketGroup group;
+        if (active_groups_.take(header.group_id, group)) {
+             try { group_callback(header.group_id, std::move(group)); } catch(const std::exception& e) {
+                 BPG_LOGE("[BPG ERR] Exception in group_callback: " << e.what());
+             } catch(...) { BPG_LOGE("[BPG ERR] Unknown exception in group_callback"); }
+            active_groups_.recycle(std::move(group));
+        }
+    }
 
-        if (!active_groups_.count(app_packet.group_id)) {
-            active_groups_[app_packet.group_id] = {};
+    // If the packet came in via the zero-copy fast path and is still buffered
+    // in its group after the callbacks ran, the view would dangle once the
+    // caller reuses its input buffer - copy it into owned storage now.
+    if (payload_is_view) {
+        AppPacket* kept_packet = active_groups_.last(header.group_id);
+        if (kept_packet && kept_packet->content) {
+            kept_packet->content->materializeView();
         }
-        active_groups_[app_packet.group_id].push_back(std::move(app_packet));
+    }
+}
 
-        const auto& stored_packet = active_groups_[header.group_id].back();
+// --- Zero-copy fast path over a contiguous input buffer ---
+size_t BpgDecoder::parseContiguous(const uint8_t* data, size_t len,
+                                   const AppPacketCallback& packet_callback,
+                                   const AppPacketGroupCallback& group_callback) {
+    size_t consumed = 0;
+    while (len - consumed >= BPG_HEADER_SIZE) {
+        PacketHeader header;
+        if (!parseHeaderFromBuffer(data + consumed, len - consumed, header)) {
+            BPG_LOGE("[BPG Decode ERR] Header parse failed in contiguous fast path.");
+            break; // Let the slow path (and its recovery behavior) deal with it
+        }
 
-        if (packet_callback) {
-            try { packet_callback(stored_packet); } catch(const std::exception& e) {
-                 std::cerr << "[BPG ERR] Exception in packet_callback: " << e.what() << std::endl;
-             } catch(...) { std::cerr << "[BPG ERR] Unknown exception in packet_callback" << std::endl; }
+        size_t total_packet_size = BPG_HEADER_SIZE + header.data_length;
+        if (len - consumed < total_packet_size) {
+            break; // Partial packet - caller buffers the remainder
         }
 
-        if (is_end && group_callback) {
-            auto group_iter = active_groups_.find(header.group_id);
-            if (group_iter != active_groups_.end()) {
-                 try { group_callback(header.group_id, std::move(group_iter->second)); } catch(const std::exception& e) {
-                     std::cerr << "[BPG ERR] Exception in group_callback: " << e.what() << std::endl;
-                 } catch(...) { std::cerr << "[BPG ERR] Unknown exception in group_callback" << std::endl; }
-                active_groups_.erase(group_iter);
-            }
+        // Parse data in place; the payload stays a view into 'data'.
+        std::shared_ptr<HybridData> hybrid_data = hybridDataPool().acquire();
+        BpgError data_err = parseDataFromBuffer(header, data + consumed + BPG_HEADER_SIZE, *hybrid_data,
+                                                false /* copy_payload */);
+        if (data_err == BpgError::Success) {
+            dispatchParsedPacket(header, std::move(hybrid_data), true /* payload_is_view */,
+                                 packet_callback, group_callback);
+        } else {
+            BPG_LOGE("BPG Decoder: Error deserializing app data for packet type " << std::string(header.tl, 2) << " (Error code: " << static_cast<int>(data_err) << ")");
         }
-    } else {
-        std::cerr << "BPG Decoder: Error deserializing app data for packet type "
-                  << std::string(header.tl, 2) << " (Error code: " << static_cast<int>(data_err) << ")" << std::endl;
+        consumed += total_packet_size;
     }
-
-    return true; 
+    return consumed;
 }
 
 BpgError BpgDecoder::processData(const uint8_t* data, size_t len,
@@ -222,14 +297,30 @@ BpgError BpgDecoder::processData(const uint8_t* data, size_t len,
         return BpgError::Success;
     }
 
-    // Append incoming data to the internal buffer (deque insert)
+    ScopedLatencyTimer decode_timer(LatencyStage::kDecode);
+
+    // --- Fast path: no partial packet pending, parse in place ---
+    // The common case (SharedArrayBuffer delivers whole groups) never touches
+    // the deque: headers are parsed directly from 'data' and payloads are
+    // handed to callbacks as non-owning views.
+    if (internal_buffer_.empty()) {
+        size_t consumed = parseContiguous(data, len, packet_callback, group_callback);
+        if (consumed == len) {
+            return BpgError::Success;
+        }
+        // Buffer only the trailing partial packet below.
+        data += consumed;
+        len -= consumed;
+    }
+
+    // Append incoming data to the internal ring buffer
     // This copy handles the volatility of the input 'data' pointer
     try {
-        internal_buffer_.insert(internal_buffer_.end(), data, data + len);
+        internal_buffer_.write(data, len);
     } catch (const std::exception& e) {
-        std::cerr << "[BPG Decode ERR] Failed to insert data into deque buffer: " << e.what() << std::endl;
+        BPG_LOGE("[BPG Decode ERR] Failed to write data into ring buffer: " << e.what());
         // Depending on severity, might want to clear buffer or just return error
-        // reset(); 
+        // reset();
         return BpgError::DecodingError; // Or a more specific error like BufferError
     }
 
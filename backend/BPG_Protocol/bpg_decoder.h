@@ -1,10 +1,12 @@
 #pragma once
 
 #include "bpg_types.h"
+#include "byte_ring_buffer.h"
+#include "group_table.h"
+#include "bpg_latency.h" // latencyNowNs for the timeout sweep
 #include <vector>
 #include <functional>
 #include <map>
-#include <deque>
 
 namespace BPG {
 
@@ -14,9 +16,19 @@ using AppPacketCallback = std::function<void(const AppPacket&)>;
 // Callback type for when a complete packet group (ending with EG) is decoded
 using AppPacketGroupCallback = std::function<void(uint32_t group_id, AppPacketGroup&& group)>; // Pass group by rvalue ref
 
+// Incremental sink for streaming consumption (see setStreamingSink): fires
+// per matching packet as it completes, WITHOUT waiting for the group's EG
+// bit. The packet's payload may be a non-owning view into the receive
+// buffer - valid only for the duration of the call (materializeView to
+// keep it).
+using PacketSink = std::function<void(const AppPacket& packet)>;
+
 class BpgDecoder {
 public:
-    BpgDecoder();
+    // 'reassembly_capacity' sizes the ring buffer used to hold fragmented
+    // packet bytes (rounded up to a power of two). It only grows if a single
+    // packet exceeds it.
+    explicit BpgDecoder(size_t reassembly_capacity = 64 * 1024);
 
     /**
      * @brief Processes incoming binary data potentially containing BPG packets.
@@ -37,24 +49,108 @@ public:
      */
     void reset();
 
+    /**
+     * @brief Caps on in-progress group reassembly (count of open groups and
+     *        total buffered payload bytes). Exceeding a cap evicts the
+     *        least-recently-touched open group. See GroupTable.
+     */
+    void setGroupLimits(size_t max_groups, size_t max_bytes) {
+        active_groups_.setLimits(max_groups, max_bytes);
+    }
+
+    /**
+     * @brief Installs a callback invoked with groups evicted by the caps
+     *        above (e.g. to log or salvage a misbehaving peer's data).
+     */
+    void setGroupEvictionCallback(GroupTable::EvictionCallback cb) {
+        active_groups_.setEvictionCallback(std::move(cb));
+    }
+
+    /**
+     * @brief Arms a timeout for incomplete groups (0 disables): a group that
+     *        has not completed 'timeout_ms' after its FIRST packet is
+     *        released by the next sweepExpiredGroups() call. Without this, a
+     *        peer that dies mid-group pins its buffered packets forever.
+     */
+    void setGroupTimeout(uint32_t timeout_ms) {
+        active_groups_.setTimeout(static_cast<uint64_t>(timeout_ms) * 1000000ull);
+    }
+
+    /**
+     * @brief Sweeps timed-out groups (call periodically, e.g. from the
+     *        plugin's update() hook). Backed by a hashed timer wheel, so the
+     *        cost is O(expired), not O(open groups). Returns the number of
+     *        groups expired by this sweep.
+     */
+    size_t sweepExpiredGroups() {
+        return active_groups_.expireGroups(latencyNowNs());
+    }
+
+    /** @brief Total groups ever expired by the timeout sweep (monitoring). */
+    uint64_t timedOutGroupCount() const { return active_groups_.timedOutGroups(); }
+
+    /**
+     * @brief Registers an incremental sink for packets matching
+     *        (group_id, tl). Matching packets are delivered to the sink the
+     *        moment they complete and are NOT buffered into the group - so
+     *        first-byte-to-handler latency is one packet, not one group,
+     *        and the group table never holds the streamed payload. The
+     *        regular packet/group callbacks do not fire for streamed
+     *        packets; when the EG packet itself streams, any NON-matching
+     *        packets buffered for that group are still flushed through the
+     *        group callback. Unmatched traffic uses the buffered
+     *        AppPacketGroup path unchanged.
+     */
+    void setStreamingSink(uint32_t group_id, const char* tl, PacketSink sink) {
+        streaming_sinks_[sinkKey(group_id, tl)] = std::move(sink);
+    }
+
+    /** @brief Removes the sink for (group_id, tl), if any. */
+    void clearStreamingSink(uint32_t group_id, const char* tl) {
+        streaming_sinks_.erase(sinkKey(group_id, tl));
+    }
+
+    /** @brief Removes all streaming sinks. */
+    void clearStreamingSinks() { streaming_sinks_.clear(); }
+
 private:
-    // Use std::deque for efficient front removal
-    std::deque<uint8_t> internal_buffer_;
-    std::map<uint32_t, AppPacketGroup> active_groups_;
+    // Ring buffer holding partial-packet bytes between processData calls
+    ByteRingBuffer internal_buffer_;
+    // Open groups, bounded and pooled (open-addressing table)
+    GroupTable active_groups_;
+    // Streaming sinks keyed by (group_id, tl) - see setStreamingSink
+    std::map<uint64_t, PacketSink> streaming_sinks_;
+
+    static uint64_t sinkKey(uint32_t group_id, const char* tl) {
+        return (static_cast<uint64_t>(group_id) << 16)
+             | (static_cast<uint64_t>(static_cast<uint8_t>(tl[0])) << 8)
+             | static_cast<uint8_t>(tl[1]);
+    }
 
     // Helper to try parsing a complete packet from the internal buffer
     // Takes non-const buffer reference if modification is needed internally
-    bool tryParsePacket(std::deque<uint8_t>& buffer, // Pass buffer by ref
+    bool tryParsePacket(ByteRingBuffer& buffer, // Pass buffer by ref
                         const AppPacketCallback& packet_callback,
                         const AppPacketGroupCallback& group_callback);
 
-    // Helper to deserialize the header (reads from buffer)
-    bool deserializeHeader(const std::deque<uint8_t>& buffer, PacketHeader& out_header);
+    // Fast path: parses complete packets directly from the caller's contiguous
+    // input buffer (no deque/staging copies). Only usable when the internal
+    // reassembly buffer is empty. Returns the number of bytes consumed; any
+    // trailing partial packet is left for the caller to buffer.
+    size_t parseContiguous(const uint8_t* data, size_t len,
+                           const AppPacketCallback& packet_callback,
+                           const AppPacketGroupCallback& group_callback);
 
-    // Helper to deserialize application data
-    BpgError deserializeAppData(const PacketHeader& header, 
-                                std::deque<uint8_t>::const_iterator data_start,
-                                HybridData& out_data);
+    // Shared tail of both parse paths: wraps the parsed header/data into an
+    // AppPacket, stores it in its group and fires the callbacks.
+    // 'hybrid_data' comes from the content pool (see hybrid_data_pool.h);
+    // 'payload_is_view' indicates it holds a non-owning view into a
+    // transient buffer; it is materialized if the packet outlives this call.
+    void dispatchParsedPacket(const PacketHeader& header,
+                              std::shared_ptr<HybridData>&& hybrid_data,
+                              bool payload_is_view,
+                              const AppPacketCallback& packet_callback,
+                              const AppPacketGroupCallback& group_callback);
 };
 
 } // namespace BPG 
\ No newline at end of file
@@ -0,0 +1,147 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <sstream>
+
+// --- Per-stage latency instrumentation ---
+// Answers "where does a frame's time go" between bytes arriving in
+// process_message and g_buffer_send_callback shipping the response. Each
+// pipeline stage records durations into a lock-free log2 histogram:
+// recording is a handful of relaxed atomic adds (no mutex, no allocation),
+// cheap enough to leave enabled in production. Snapshots are exported on
+// demand as JSON (see toJson) for the frontend's "ST" stats packet.
+
+namespace BPG {
+
+// Monotonic timestamp in nanoseconds. steady_clock compiles down to a
+// single vDSO/counter read on the platforms we ship on, without the TSC
+// frequency-calibration headaches of raw cycle counters.
+inline uint64_t latencyNowNs() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+enum class LatencyStage : size_t {
+    kDecode = 0,        // BpgDecoder::processData, per call
+    kGroupDispatch,     // Queue wait: GroupDispatcher submit -> worker pickup
+    kPythonRoundTrip,   // Request enqueued to SHM -> correlated response
+    kEncodeSend,        // Group encode + buffer claim/notify cycles
+    kCount
+};
+
+inline const char* latencyStageName(LatencyStage stage) {
+    switch (stage) {
+        case LatencyStage::kDecode:          return "decode";
+        case LatencyStage::kGroupDispatch:   return "group_dispatch";
+        case LatencyStage::kPythonRoundTrip: return "python_round_trip";
+        case LatencyStage::kEncodeSend:      return "encode_send";
+        default:                             return "?";
+    }
+}
+
+class LatencyStats {
+public:
+    static LatencyStats& instance() {
+        static LatencyStats stats;
+        return stats;
+    }
+
+    // Hot path: relaxed atomics only. Bucket i counts durations in
+    // [2^(i-1), 2^i) microseconds (bucket 0 = sub-microsecond).
+    void record(LatencyStage stage, uint64_t duration_ns) {
+        StageHist& h = stages_[static_cast<size_t>(stage)];
+        h.count.fetch_add(1, std::memory_order_relaxed);
+        h.sum_ns.fetch_add(duration_ns, std::memory_order_relaxed);
+        h.buckets[bucketIndex(duration_ns)].fetch_add(1, std::memory_order_relaxed);
+        uint64_t prev_max = h.max_ns.load(std::memory_order_relaxed);
+        while (duration_ns > prev_max &&
+               !h.max_ns.compare_exchange_weak(prev_max, duration_ns,
+                                               std::memory_order_relaxed)) {
+        }
+    }
+
+    // Snapshot as JSON (allocates; only called on demand, never on the hot
+    // path). Counters keep ticking while this reads, so a snapshot is
+    // approximate across stages - fine for a live breakdown.
+    std::string toJson() const {
+        std::ostringstream oss;
+        oss << "{\"bucket_unit\":\"log2_us\",\"stages\":{";
+        for (size_t s = 0; s < static_cast<size_t>(LatencyStage::kCount); ++s) {
+            const StageHist& h = stages_[s];
+            uint64_t count = h.count.load(std::memory_order_relaxed);
+            uint64_t sum_ns = h.sum_ns.load(std::memory_order_relaxed);
+            if (s != 0) oss << ",";
+            oss << "\"" << latencyStageName(static_cast<LatencyStage>(s)) << "\":{"
+                << "\"count\":" << count
+                << ",\"avg_us\":" << (count ? (sum_ns / count) / 1000 : 0)
+                << ",\"max_us\":" << h.max_ns.load(std::memory_order_relaxed) / 1000
+                << ",\"buckets\":[";
+            for (size_t b = 0; b < kBucketCount; ++b) {
+                if (b != 0) oss << ",";
+                oss << h.buckets[b].load(std::memory_order_relaxed);
+            }
+            oss << "]}";
+        }
+        oss << "}}";
+        return oss.str();
+    }
+
+    void reset() {
+        for (StageHist& h : stages_) {
+            h.count.store(0, std::memory_order_relaxed);
+            h.sum_ns.store(0, std::memory_order_relaxed);
+            h.max_ns.store(0, std::memory_order_relaxed);
+            for (auto& b : h.buckets) b.store(0, std::memory_order_relaxed);
+        }
+    }
+
+private:
+    LatencyStats() = default;
+
+    // 24 log2 buckets cover <1us up to ~8.4s; anything beyond clamps into
+    // the last bucket.
+    static constexpr size_t kBucketCount = 24;
+
+    struct StageHist {
+        std::atomic<uint64_t> count{0};
+        std::atomic<uint64_t> sum_ns{0};
+        std::atomic<uint64_t> max_ns{0};
+        std::atomic<uint64_t> buckets[kBucketCount]{};
+    };
+
+    static size_t bucketIndex(uint64_t duration_ns) {
+        uint64_t us = duration_ns / 1000;
+        if (us == 0) return 0;
+#if defined(__GNUC__) || defined(__clang__)
+        size_t idx = static_cast<size_t>(64 - __builtin_clzll(us));
+#else
+        size_t idx = 0;
+        while (us) { ++idx; us >>= 1; }
+#endif
+        return idx < kBucketCount ? idx : kBucketCount - 1;
+    }
+
+    StageHist stages_[static_cast<size_t>(LatencyStage::kCount)];
+};
+
+// RAII helper stamping a stage's duration on scope exit.
+class ScopedLatencyTimer {
+public:
+    explicit ScopedLatencyTimer(LatencyStage stage)
+        : stage_(stage), start_ns_(latencyNowNs()) {}
+    ~ScopedLatencyTimer() {
+        LatencyStats::instance().record(stage_, latencyNowNs() - start_ns_);
+    }
+    ScopedLatencyTimer(const ScopedLatencyTimer&) = delete;
+    ScopedLatencyTimer& operator=(const ScopedLatencyTimer&) = delete;
+
+private:
+    LatencyStage stage_;
+    uint64_t start_ns_;
+};
+
+} // namespace BPG
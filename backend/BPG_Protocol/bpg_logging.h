@@ -0,0 +1,175 @@
+#ifndef BPG_LOGGING_H
+#define BPG_LOGGING_H
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <chrono>
+
+// --- Leveled logging with a lock-free ring sink ---
+// Replaces the raw std::cout/std::cerr lines on the packet hot path. Two
+// mechanisms keep logging off the critical path:
+//
+//  1. Compile-time max level: BPG_LOG_COMPILE_LEVEL is a plain integer
+//     constant, so statements above it (TRACE by default, including all the
+//     per-packet hex dumps) fold to nothing - no formatting, no branch.
+//  2. Lock-free ring sink: enabled statements format into a local
+//     ostringstream and push the finished line into a bounded MPSC ring
+//     (Vyukov-style sequenced cells). A background thread drains the ring to
+//     stdout/stderr, so producer threads never serialize on the stdio lock.
+//     When the ring is full the line is DROPPED (and counted) rather than
+//     blocking the producer.
+//
+// Usage:
+//     BPG_LOGE("[Tag] something failed: " << err);   // Error
+//     BPG_LOGW("[Tag] suspicious: " << value);        // Warning
+//     BPG_LOGI("[Tag] initialized");                  // Info (default max)
+//     BPG_LOGD("[Tag] state=" << s);                  // Debug
+//     BPG_LOGT("[Tag] per-packet detail");            // Trace (compiled out)
+//
+// Build with -DBPG_LOG_COMPILE_LEVEL=4 to compile TRACE back in; call
+// BPG::logging::setRuntimeLevel() to further restrict at runtime.
+
+// Compile-time ceiling: 0=Error 1=Warn 2=Info 3=Debug 4=Trace
+#ifndef BPG_LOG_COMPILE_LEVEL
+#define BPG_LOG_COMPILE_LEVEL 2
+#endif
+
+namespace BPG {
+namespace logging {
+
+enum Level : int {
+    kError = 0,
+    kWarn  = 1,
+    kInfo  = 2,
+    kDebug = 3,
+    kTrace = 4
+};
+
+class RingSink {
+public:
+    static RingSink& instance() {
+        static RingSink sink;
+        return sink;
+    }
+
+    int runtimeLevel() const { return runtime_level_.load(std::memory_order_relaxed); }
+    void setRuntimeLevel(int level) { runtime_level_.store(level, std::memory_order_relaxed); }
+
+    // Lock-free producer side. Drops (and counts) when the ring is full so
+    // the hot path never blocks on a slow consumer.
+    void push(int level, const std::string& line) {
+        Entry* cell;
+        uint64_t pos = head_.load(std::memory_order_relaxed);
+        for (;;) {
+            cell = &entries_[pos & (kEntryCount - 1)];
+            uint64_t seq = cell->seq.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+            if (diff == 0) {
+                if (head_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+            } else if (diff < 0) {
+                dropped_.fetch_add(1, std::memory_order_relaxed); // Ring full
+                return;
+            } else {
+                pos = head_.load(std::memory_order_relaxed); // Lost the race, reload
+            }
+        }
+        size_t len = line.size();
+        if (len > kMaxLine) len = kMaxLine;
+        std::memcpy(cell->text, line.data(), len);
+        cell->level = static_cast<uint8_t>(level);
+        cell->len = static_cast<uint16_t>(len);
+        cell->seq.store(pos + 1, std::memory_order_release); // Publish to the drainer
+    }
+
+private:
+    static const size_t kEntryCount = 1024; // Power of two
+    static const size_t kMaxLine = 236;
+
+    struct Entry {
+        std::atomic<uint64_t> seq;
+        uint8_t level;
+        uint16_t len;
+        char text[kMaxLine];
+    };
+
+    RingSink() {
+        for (size_t i = 0; i < kEntryCount; ++i) {
+            entries_[i].seq.store(i, std::memory_order_relaxed);
+        }
+        drainer_ = std::thread([this] { drainLoop(); });
+    }
+
+    ~RingSink() {
+        running_.store(false, std::memory_order_relaxed);
+        if (drainer_.joinable()) drainer_.join();
+    }
+
+    RingSink(const RingSink&) = delete;
+    RingSink& operator=(const RingSink&) = delete;
+
+    void drainLoop() {
+        static const char* kLevelTag[] = { "[E] ", "[W] ", "[I] ", "[D] ", "[T] " };
+        uint64_t pos = 0;
+        uint64_t dropped_reported = 0;
+        for (;;) {
+            Entry& cell = entries_[pos & (kEntryCount - 1)];
+            if (cell.seq.load(std::memory_order_acquire) == pos + 1) {
+                FILE* out = (cell.level <= kWarn) ? stderr : stdout;
+                std::fwrite(kLevelTag[cell.level], 1, 4, out);
+                std::fwrite(cell.text, 1, cell.len, out);
+                std::fputc('\n', out);
+                cell.seq.store(pos + kEntryCount, std::memory_order_release); // Recycle cell
+                ++pos;
+                continue;
+            }
+            uint64_t dropped_now = dropped_.load(std::memory_order_relaxed);
+            if (dropped_now != dropped_reported) {
+                std::fprintf(stderr, "[W] [BPG Log] %llu line(s) dropped (ring full)\n",
+                             static_cast<unsigned long long>(dropped_now - dropped_reported));
+                dropped_reported = dropped_now;
+            }
+            if (!running_.load(std::memory_order_relaxed)) break; // Drained + stopping
+            std::fflush(stdout);
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        std::fflush(stdout);
+        std::fflush(stderr);
+    }
+
+    Entry entries_[kEntryCount];
+    std::atomic<uint64_t> head_{0};
+    std::atomic<uint64_t> dropped_{0};
+    std::atomic<int> runtime_level_{BPG_LOG_COMPILE_LEVEL};
+    std::atomic<bool> running_{true};
+    std::thread drainer_;
+};
+
+inline void setRuntimeLevel(int level) { RingSink::instance().setRuntimeLevel(level); }
+
+} // namespace logging
+} // namespace BPG
+
+// The compile-level comparison is a constant expression, so statements above
+// BPG_LOG_COMPILE_LEVEL are removed entirely by dead-code elimination.
+#define BPG_LOG(level_, expr_)                                                    \
+    do {                                                                          \
+        if ((level_) <= BPG_LOG_COMPILE_LEVEL &&                                  \
+            (level_) <= ::BPG::logging::RingSink::instance().runtimeLevel()) {    \
+            std::ostringstream bpg_log_oss_;                                      \
+            bpg_log_oss_ << expr_;                                                \
+            ::BPG::logging::RingSink::instance().push((level_), bpg_log_oss_.str()); \
+        }                                                                         \
+    } while (0)
+
+#define BPG_LOGE(expr_) BPG_LOG(::BPG::logging::kError, expr_)
+#define BPG_LOGW(expr_) BPG_LOG(::BPG::logging::kWarn, expr_)
+#define BPG_LOGI(expr_) BPG_LOG(::BPG::logging::kInfo, expr_)
+#define BPG_LOGD(expr_) BPG_LOG(::BPG::logging::kDebug, expr_)
+#define BPG_LOGT(expr_) BPG_LOG(::BPG::logging::kTrace, expr_)
+
+#endif // BPG_LOGGING_H
@@ -16,6 +16,9 @@ namespace BPG {
 // Breakdown: group_id(4) + target_id(4) + tl(2) + prop(4) + data_length(4) = 18
 constexpr size_t BPG_HEADER_SIZE = 18;
 constexpr uint32_t BPG_PROP_EG_BIT_MASK = 0x00000001; // Mask for the EG bit (LSB of prop field)
+// Set when the packet's metadata bytes are binary TLV (see tlv_metadata.h)
+// rather than a JSON string. Receivers without the bit see plain JSON.
+constexpr uint32_t BPG_PROP_TLV_META_BIT_MASK = 0x00000002;
 
 // Two-letter packet type identifier
 typedef char PacketType[2];
@@ -69,9 +72,65 @@ struct PacketHeader {
 class HybridData {
     public:
     std::string metadata_str; // Describes the binary data. UTF-8 encoded string.
+    // True when metadata_str holds binary TLV fields (tlv_metadata.h) instead
+    // of JSON - mirrored into/out of the packet header's prop field, so the
+    // wire format and the encode/size paths below are unchanged either way.
+    bool metadata_is_tlv = false;
     std::vector<uint8_t> internal_binary_bytes;//if empty, use binary_bytes2
     BufferWriter external_binary_bytes;
 
+    // Non-owning view of the binary payload, set by the decoder's zero-copy
+    // fast path instead of filling internal_binary_bytes. The view points into
+    // the caller's receive buffer and is ONLY valid for the duration of the
+    // decode callback that delivered it. Call materializeView() to keep the
+    // bytes beyond that.
+    const uint8_t* binary_view = nullptr;
+    size_t binary_view_size = 0;
+
+    // Attaches a non-owning (pointer, length) payload for sending. The bytes
+    // are NOT copied: the caller must keep them valid until encode() has run.
+    // Takes precedence over binary_view; internal_binary_bytes wins if set.
+    void setExternalBinary(uint8_t* data, size_t length) {
+        external_binary_bytes.init(data, length, length);
+    }
+
+    // Unified accessors: prefer the owning vector, then an attached external
+    // payload, then a decoder view.
+    const uint8_t* getBinaryData() const {
+        if (!internal_binary_bytes.empty()) return internal_binary_bytes.data();
+        if (external_binary_bytes.size() > 0) return external_binary_bytes.data();
+        return binary_view;
+    }
+    size_t getBinarySize() const {
+        if (!internal_binary_bytes.empty()) return internal_binary_bytes.size();
+        if (external_binary_bytes.size() > 0) return external_binary_bytes.size();
+        return binary_view_size;
+    }
+
+    // --- In-place metadata formatting ---
+    // beginMetadata() sizes metadata_str to a worst case and returns a writer
+    // over its storage; format with the BufferWriter append_* helpers, then
+    // commitMetadata() trims to what was actually written. On a pooled object
+    // whose capacity is warm (recycleReset keeps it) neither call allocates,
+    // unlike composing the string from chained operator+ temporaries.
+    BufferWriter beginMetadata(size_t max_len) {
+        metadata_str.resize(max_len);
+        return BufferWriter(reinterpret_cast<uint8_t*>(&metadata_str[0]), max_len);
+    }
+    void commitMetadata(const BufferWriter& writer) {
+        metadata_str.resize(writer.size());
+    }
+
+    // Copies a pending view into internal_binary_bytes so the payload
+    // survives after the receive buffer is reused.
+    void materializeView() {
+        if (binary_view && internal_binary_bytes.empty()) {
+            internal_binary_bytes.assign(binary_view, binary_view + binary_view_size);
+        }
+        binary_view = nullptr;
+        binary_view_size = 0;
+    }
+
     // Calculates the size needed to encode this HybridData instance.
     virtual size_t calculateEncodedSize() const {
         size_t binary_size = 0;
@@ -85,11 +144,10 @@ class HybridData {
     virtual BpgError encode(BufferWriter& writer) const {
         uint32_t json_len = static_cast<uint32_t>(metadata_str.length());
         uint32_t json_len_n = htonl(json_len);
-        
-        size_t binary_size = calculateEncodedSize();
-
 
-        size_t required_size = sizeof(uint32_t) + json_len + binary_size;
+        // calculateEncodedSize() already covers the length prefix + metadata
+        // + binary payload - this is the exact on-wire size.
+        size_t required_size = calculateEncodedSize();
 
         if (!writer.canWrite(required_size)) {
             return BpgError::BufferTooSmall;
@@ -112,10 +170,31 @@ class HybridData {
             writer.write(internal_binary_bytes.data(), internal_binary_bytes.size());
             return BpgError::Success;
         }
+        // Non-owning external payload: emitted straight from the caller's
+        // memory, no staging copy.
+        if (external_binary_bytes.size() > 0) {
+            if (!writer.canWrite(external_binary_bytes.size())) return BpgError::BufferTooSmall;
+            writer.write(external_binary_bytes.data(), external_binary_bytes.size());
+            return BpgError::Success;
+        }
         return BpgError::Success;
     }
 
+    // Returns the object to a pristine state for pool reuse while KEEPING
+    // allocated capacity (clear() on the string/vector does not free their
+    // buffers - that retained capacity is the point of pooling). Derived
+    // content types override to also drop their own payload references.
+    virtual void recycleReset() {
+        metadata_str.clear();
+        metadata_is_tlv = false;
+        internal_binary_bytes.clear();
+        external_binary_bytes.init(nullptr, 0);
+        binary_view = nullptr;
+        binary_view_size = 0;
+    }
+
     HybridData() : external_binary_bytes(nullptr, 0) {}
+    virtual ~HybridData() = default;
 };
 
 // Structure representing a packet at the application layer
@@ -149,6 +228,7 @@ struct AppPacket {
         header.target_id = target_id;
         std::memcpy(header.tl, tl, sizeof(PacketType));
         header.prop = is_end_of_group ? BPG_PROP_EG_BIT_MASK : 0;
+        if (content->metadata_is_tlv) header.prop |= BPG_PROP_TLV_META_BIT_MASK;
         header.data_length = data_len;
 
         // 3. Check if writer has enough space for header AND data
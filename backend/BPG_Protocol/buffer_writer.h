@@ -74,6 +74,45 @@ public:
     return append(vec.data(), vec.size());
     }
 
+    // --- Fmt-style text appends ---
+    // For composing metadata/JSON straight into a buffer without chaining
+    // std::string temporaries (the old operator+ pattern allocated ~10 times
+    // per frame on the send path). All return false when out of space.
+
+    // Appends a NUL-terminated literal (the terminator is not written)
+    bool append_literal(const char* str) {
+        return append(str, std::strlen(str));
+    }
+
+    bool append_char(char c) {
+        return append(&c, 1);
+    }
+
+    // Appends the decimal digits of an unsigned value (no allocation)
+    bool append_unsigned(uint64_t value) {
+        char digits[20]; // Enough for 2^64-1
+        size_t n = 0;
+        do {
+            digits[n++] = static_cast<char>('0' + (value % 10));
+            value /= 10;
+        } while (value != 0);
+        if (!canWrite(n)) return false;
+        while (n > 0) {
+            start_ptr_[current_offset_++] = static_cast<uint8_t>(digits[--n]);
+        }
+        return true;
+    }
+
+    // Appends the decimal digits of a signed value (no allocation)
+    bool append_signed(int64_t value) {
+        if (value < 0) {
+            if (!append_char('-')) return false;
+            // Negate via uint64_t so INT64_MIN is handled
+            return append_unsigned(~static_cast<uint64_t>(value) + 1);
+        }
+        return append_unsigned(static_cast<uint64_t>(value));
+    }
+
     uint8_t* claim_space(size_t size){
         if(!canWrite(size)){
             return nullptr;
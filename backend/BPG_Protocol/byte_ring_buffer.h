@@ -0,0 +1,104 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring> // For memcpy
+#include <vector>
+#include <algorithm> // For std::min, std::max
+
+namespace BPG {
+
+// --- ByteRingBuffer Utility Class ---
+// Power-of-two ring buffer used as the decoder's packet reassembly storage.
+// Writing is at most two memcpys (worst case: the region wraps), and readers
+// can peek at a contiguous run of bytes without consuming them. If a peeked
+// run wraps around the end of storage it is linearized into an internal
+// scratch buffer (the only copy the fragmented path ever pays).
+//
+// The buffer grows (to the next power of two) only when a single packet is
+// larger than the current capacity; steady-state traffic never allocates.
+class ByteRingBuffer {
+public:
+    explicit ByteRingBuffer(size_t initial_capacity = 64 * 1024) {
+        storage_.resize(roundUpPow2(std::max(initial_capacity, (size_t)16)));
+    }
+
+    size_t size() const { return count_; }
+    size_t capacity() const { return storage_.size(); }
+    bool empty() const { return count_ == 0; }
+
+    void clear() {
+        head_ = 0;
+        count_ = 0;
+    }
+
+    // Appends 'len' bytes, growing the ring if they do not fit.
+    void write(const uint8_t* data, size_t len) {
+        if (len == 0) return;
+        if (count_ + len > storage_.size()) {
+            growTo(count_ + len);
+        }
+        size_t write_pos = (head_ + count_) & mask();
+        size_t first_chunk = std::min(len, storage_.size() - write_pos);
+        std::memcpy(storage_.data() + write_pos, data, first_chunk);
+        if (first_chunk < len) {
+            std::memcpy(storage_.data(), data + first_chunk, len - first_chunk);
+        }
+        count_ += len;
+    }
+
+    // Returns a pointer to 'len' contiguous readable bytes without consuming
+    // them, or nullptr if fewer than 'len' bytes are buffered. When the run
+    // does not wrap this is a direct pointer into the ring (no copy); when it
+    // wraps, the bytes are linearized into the internal scratch buffer and
+    // the returned pointer stays valid until the next call that mutates the
+    // ring or peeks again.
+    const uint8_t* peekContiguous(size_t len) {
+        if (len > count_) return nullptr;
+        size_t first_chunk = storage_.size() - head_;
+        if (len <= first_chunk) {
+            return storage_.data() + head_; // Unwrapped: zero-copy peek
+        }
+        if (scratch_.size() < len) scratch_.resize(len);
+        std::memcpy(scratch_.data(), storage_.data() + head_, first_chunk);
+        std::memcpy(scratch_.data() + first_chunk, storage_.data(), len - first_chunk);
+        return scratch_.data();
+    }
+
+    // Discards 'len' bytes from the front of the ring.
+    void consume(size_t len) {
+        len = std::min(len, count_);
+        head_ = (head_ + len) & mask();
+        count_ -= len;
+        if (count_ == 0) head_ = 0; // Re-anchor so future peeks stay unwrapped
+    }
+
+private:
+    size_t mask() const { return storage_.size() - 1; }
+
+    static size_t roundUpPow2(size_t v) {
+        size_t p = 1;
+        while (p < v) p <<= 1;
+        return p;
+    }
+
+    // Reallocates to the next power of two >= needed, linearizing content.
+    void growTo(size_t needed) {
+        std::vector<uint8_t> bigger(roundUpPow2(needed));
+        size_t first_chunk = std::min(count_, storage_.size() - head_);
+        std::memcpy(bigger.data(), storage_.data() + head_, first_chunk);
+        if (first_chunk < count_) {
+            std::memcpy(bigger.data() + first_chunk, storage_.data(), count_ - first_chunk);
+        }
+        storage_.swap(bigger);
+        head_ = 0;
+    }
+
+    std::vector<uint8_t> storage_;
+    std::vector<uint8_t> scratch_; // Linearization target for wrapped peeks
+    size_t head_ = 0;              // Read index
+    size_t count_ = 0;             // Bytes currently buffered
+};
+// --- End ByteRingBuffer ---
+
+} // namespace BPG
@@ -0,0 +1,132 @@
+#ifndef BPG_GROUP_DISPATCH_H
+#define BPG_GROUP_DISPATCH_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "bpg_types.h"
+#include "bpg_logging.h"
+#include "bpg_latency.h"
+
+namespace BPG {
+
+// --- Dispatch stage between decode and application logic ---
+// BpgDecoder::processData used to invoke the group handler synchronously on
+// the thread draining the receive buffer, so one slow handler (image render,
+// blocking buffer request, ...) stalled decode of everything behind it.
+// GroupDispatcher decouples the two: completed AppPacketGroups are pushed
+// onto bounded per-worker queues and handled by a small pool.
+//
+// Ordering: a group_id is hashed to a fixed worker, and each worker drains
+// its queue FIFO - so groups with the same id (and retransmissions of it)
+// are always handled in completion order, while unrelated ids proceed in
+// parallel.
+//
+// Backpressure: submit() blocks (bounded by the queue capacity) when the
+// target worker is saturated rather than dropping groups or growing without
+// limit. Payload views from the decoder's zero-copy fast path are
+// materialized before the group crosses threads.
+class GroupDispatcher {
+public:
+    using GroupHandler = std::function<void(uint32_t group_id, AppPacketGroup&& group)>;
+
+    explicit GroupDispatcher(GroupHandler handler,
+                             size_t worker_count = 2,
+                             size_t queue_capacity = 64)
+        : handler_(std::move(handler)),
+          queue_capacity_(queue_capacity ? queue_capacity : 1),
+          workers_(worker_count ? worker_count : 1) {
+        for (size_t i = 0; i < workers_.size(); ++i) {
+            workers_[i].thread = std::thread([this, i] { workerLoop(workers_[i]); });
+        }
+    }
+
+    ~GroupDispatcher() {
+        running_.store(false, std::memory_order_relaxed);
+        for (auto& w : workers_) {
+            std::lock_guard<std::mutex> lock(w.mtx);
+            w.cv_pop.notify_all();
+            w.cv_push.notify_all();
+        }
+        for (auto& w : workers_) {
+            if (w.thread.joinable()) w.thread.join();
+        }
+    }
+
+    GroupDispatcher(const GroupDispatcher&) = delete;
+    GroupDispatcher& operator=(const GroupDispatcher&) = delete;
+
+    // Hands a completed group to the pool. Safe to call from the decode
+    // thread's group callback; the packets' payload views are copied into
+    // owning storage here because the receive buffer is reused as soon as
+    // the callback returns. Returns false if the dispatcher is shutting down.
+    bool submit(uint32_t group_id, AppPacketGroup&& group) {
+        for (auto& packet : group) {
+            if (packet.content) packet.content->materializeView();
+        }
+        Worker& w = workers_[group_id % workers_.size()];
+        std::unique_lock<std::mutex> lock(w.mtx);
+        w.cv_push.wait(lock, [&] {
+            return w.queue.size() < queue_capacity_ || !running_.load(std::memory_order_relaxed);
+        });
+        if (!running_.load(std::memory_order_relaxed)) return false;
+        w.queue.push_back(Item{group_id, std::move(group), latencyNowNs()});
+        w.cv_pop.notify_one();
+        return true;
+    }
+
+private:
+    struct Item {
+        uint32_t group_id;
+        AppPacketGroup group;
+        uint64_t enqueue_ns; // For the dispatch-queue-wait latency stage
+    };
+
+    struct Worker {
+        std::mutex mtx;
+        std::condition_variable cv_push; // Signalled when space frees up
+        std::condition_variable cv_pop;  // Signalled when work arrives
+        std::deque<Item> queue;
+        std::thread thread;
+    };
+
+    void workerLoop(Worker& w) {
+        for (;;) {
+            Item item;
+            {
+                std::unique_lock<std::mutex> lock(w.mtx);
+                w.cv_pop.wait(lock, [&] {
+                    return !w.queue.empty() || !running_.load(std::memory_order_relaxed);
+                });
+                if (w.queue.empty()) return; // Shutdown with queue drained
+                item = std::move(w.queue.front());
+                w.queue.pop_front();
+                w.cv_push.notify_one();
+            }
+            LatencyStats::instance().record(LatencyStage::kGroupDispatch,
+                                            latencyNowNs() - item.enqueue_ns);
+            try {
+                handler_(item.group_id, std::move(item.group));
+            } catch (const std::exception& e) {
+                BPG_LOGE("[BPG Dispatch] Exception in group handler: " << e.what());
+            } catch (...) {
+                BPG_LOGE("[BPG Dispatch] Unknown exception in group handler.");
+            }
+        }
+    }
+
+    GroupHandler handler_;
+    size_t queue_capacity_;
+    std::atomic<bool> running_{true};
+    std::vector<Worker> workers_;
+};
+
+} // namespace BPG
+
+#endif // BPG_GROUP_DISPATCH_H
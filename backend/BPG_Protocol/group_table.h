@@ -0,0 +1,314 @@
+#ifndef BPG_GROUP_TABLE_H
+#define BPG_GROUP_TABLE_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <utility>
+#include <vector>
+
+#include "bpg_latency.h" // latencyNowNs for deadline stamping
+#include "bpg_types.h"
+
+namespace BPG {
+
+// --- In-progress group reassembly table ---
+// Replaces the decoder's std::map<uint32_t, AppPacketGroup>: an
+// open-addressing hash table (linear probing, power-of-two buckets) sized for
+// the handful of groups that are ever concurrently open, so the per-packet
+// lookup is a couple of cache lines instead of a red-black tree walk.
+//
+// AppPacketGroup vectors are recycled through a small free list - a group
+// slot reuses the capacity of a previously completed group instead of
+// reallocating from zero for every group.
+//
+// The table is bounded in both group count and buffered payload bytes. When a
+// new packet would exceed either cap, the least-recently-touched open group
+// is evicted and handed to the eviction callback (a sender that never sets
+// the EG bit can therefore not grow the decoder's heap without bound).
+//
+// Groups are additionally aged out by a hashed timer wheel: each group's
+// deadline is stamped on its FIRST packet (setTimeout) and the id filed into
+// the wheel bucket covering that deadline. expireGroups() only walks the
+// buckets whose time slice has passed since the previous sweep, so the
+// periodic sweep costs O(expired), not O(open groups). Expired groups go
+// back to the vector free list and bump a counter for monitoring (without
+// this, a peer dying mid-group pins its buffered packets forever).
+class GroupTable {
+public:
+    using EvictionCallback =
+        std::function<void(uint32_t group_id, AppPacketGroup&& group, size_t buffered_bytes)>;
+
+    explicit GroupTable(size_t max_groups = 64,
+                        size_t max_bytes = 64 * 1024 * 1024)
+        : max_groups_(max_groups ? max_groups : 1),
+          max_bytes_(max_bytes),
+          slots_(16) {}
+
+    void setLimits(size_t max_groups, size_t max_bytes) {
+        max_groups_ = max_groups ? max_groups : 1;
+        max_bytes_ = max_bytes;
+    }
+
+    void setEvictionCallback(EvictionCallback cb) { on_evict_ = std::move(cb); }
+
+    // Arms the timeout for groups opened from now on (0 disables). The
+    // deadline is stamped once, on the group's first packet - later packets
+    // do not re-arm it, so a trickling-but-never-finishing group still expires.
+    void setTimeout(uint64_t timeout_ns) { timeout_ns_ = timeout_ns; }
+
+    // Appends 'packet' to its group, creating the group if needed, and
+    // returns a pointer to the stored packet (valid until the table is
+    // touched again). Enforces the caps by evicting the stalest OTHER group
+    // first; returns nullptr only if the packet alone exceeds the byte cap.
+    AppPacket* append(uint32_t group_id, AppPacket&& packet) {
+        size_t packet_bytes = packetBytes(packet);
+        if (max_bytes_ && packet_bytes > max_bytes_) return nullptr;
+
+        Slot* slot = findSlot(group_id);
+        if (!slot || slot->state != kOccupied) {
+            // New group: make room first
+            while (occupied_ >= max_groups_ ||
+                   (max_bytes_ && total_bytes_ + packet_bytes > max_bytes_)) {
+                if (!evictStalest(group_id)) break;
+            }
+            if (loadFactorHigh()) {
+                grow();
+            }
+            slot = findSlot(group_id);
+            slot->group_id = group_id;
+            slot->state = kOccupied;
+            slot->bytes = 0;
+            slot->group = takeRecycledGroup();
+            ++occupied_;
+            // Stamp the timeout deadline (first packet only) and file the id
+            // into the wheel bucket covering it
+            if (timeout_ns_) {
+                slot->deadline_ns = latencyNowNs() + timeout_ns_;
+                wheelBucket(slot->deadline_ns).push_back(group_id);
+            } else {
+                slot->deadline_ns = 0;
+            }
+        } else if (max_bytes_ && total_bytes_ + packet_bytes > max_bytes_) {
+            // Existing group, byte cap hit: evict others to make room
+            while (max_bytes_ && total_bytes_ + packet_bytes > max_bytes_) {
+                if (!evictStalest(group_id)) break;
+            }
+        }
+
+        slot->bytes += packet_bytes;
+        total_bytes_ += packet_bytes;
+        slot->last_touch = ++touch_counter_;
+        slot->group.push_back(std::move(packet));
+        return &slot->group.back();
+    }
+
+    // Pointer to the most recently appended packet of a group, or nullptr.
+    AppPacket* last(uint32_t group_id) {
+        Slot* slot = findSlot(group_id);
+        if (!slot || slot->state != kOccupied || slot->group.empty()) return nullptr;
+        return &slot->group.back();
+    }
+
+    // Moves a completed group out of the table. Returns false if the id is
+    // not open. The slot's vector (whatever capacity the consumer left
+    // behind) goes back on the free list.
+    bool take(uint32_t group_id, AppPacketGroup& out) {
+        Slot* slot = findSlot(group_id);
+        if (!slot || slot->state != kOccupied) return false;
+        out = std::move(slot->group);
+        releaseSlot(*slot);
+        return true;
+    }
+
+    size_t openGroups() const { return occupied_; }
+    size_t bufferedBytes() const { return total_bytes_; }
+    uint64_t timedOutGroups() const { return timed_out_groups_; }
+
+    // Releases every group whose deadline has passed, walking only the wheel
+    // slices that fully elapsed since the last sweep. Expired groups go back
+    // to the vector free list (their packets' pooled contents recycle through
+    // the shared_ptr drop). Returns the number of groups expired this call.
+    size_t expireGroups(uint64_t now_ns) {
+        if (!timeout_ns_) return 0;
+        uint64_t current_slice = now_ns >> kSliceShiftNs;
+        // Only slices strictly in the past are swept, so every matching entry
+        // in them is guaranteed expired (lateness is bounded at two slices)
+        uint64_t target = (current_slice == 0) ? 0 : current_slice - 1;
+        if (target <= sweep_cursor_) return 0;
+        uint64_t slices = target - sweep_cursor_;
+        if (slices > kWheelSlots) slices = kWheelSlots; // One lap covers all buckets
+        size_t expired = 0;
+        for (uint64_t s = 1; s <= slices; ++s) {
+            size_t bucket_idx = static_cast<size_t>((sweep_cursor_ + s) & (kWheelSlots - 1));
+            std::vector<uint32_t>& bucket = wheel_[bucket_idx];
+            for (size_t i = 0; i < bucket.size();) {
+                Slot* slot = findSlot(bucket[i]);
+                bool keep = false;
+                if (slot && slot->state == kOccupied && slot->deadline_ns != 0) {
+                    if (slot->deadline_ns <= now_ns) {
+                        releaseSlot(*slot); // Recycles the group vector
+                        ++timed_out_groups_;
+                        ++expired;
+                    } else if ((static_cast<size_t>(slot->deadline_ns >> kSliceShiftNs)
+                                & (kWheelSlots - 1)) == bucket_idx) {
+                        keep = true; // Same bucket, a future wheel rotation
+                    }
+                    // else: stale entry - the id was reused and re-filed
+                }
+                if (keep) {
+                    ++i;
+                } else {
+                    bucket[i] = bucket.back();
+                    bucket.pop_back();
+                }
+            }
+        }
+        sweep_cursor_ = target;
+        return expired;
+    }
+
+    void clear() {
+        for (auto& slot : slots_) {
+            if (slot.state == kOccupied) releaseSlot(slot);
+            slot.state = kEmpty;
+        }
+        for (auto& bucket : wheel_) bucket.clear();
+        occupied_ = 0;
+        total_bytes_ = 0;
+    }
+
+    // Returns a group vector to the free list so its capacity can be reused.
+    // Callers that are done with a group they received (via take() or the
+    // eviction callback) can feed it back here.
+    void recycle(AppPacketGroup&& group) {
+        group.clear();
+        if (free_groups_.size() < kMaxFreeGroups) {
+            free_groups_.push_back(std::move(group));
+        }
+    }
+
+private:
+    enum SlotState : uint8_t { kEmpty = 0, kOccupied = 1, kTombstone = 2 };
+
+    struct Slot {
+        uint32_t group_id = 0;
+        uint8_t state = kEmpty;
+        uint64_t last_touch = 0;
+        uint64_t deadline_ns = 0; // Timeout deadline (0 = not armed)
+        size_t bytes = 0;
+        AppPacketGroup group;
+    };
+
+    static size_t packetBytes(const AppPacket& packet) {
+        if (!packet.content) return sizeof(AppPacket);
+        return sizeof(AppPacket) + packet.content->metadata_str.size() +
+               packet.content->getBinarySize();
+    }
+
+    static size_t hashId(uint32_t id) {
+        // Fibonacci hashing spreads sequential group ids across buckets
+        return static_cast<size_t>(id * 2654435769u);
+    }
+
+    // Returns the slot holding 'group_id', or the first insertable slot of
+    // its probe chain. Never returns nullptr (the table keeps spare room).
+    Slot* findSlot(uint32_t group_id) {
+        size_t mask = slots_.size() - 1;
+        size_t idx = hashId(group_id) & mask;
+        Slot* first_free = nullptr;
+        for (size_t probes = 0; probes <= mask; ++probes, idx = (idx + 1) & mask) {
+            Slot& slot = slots_[idx];
+            if (slot.state == kOccupied) {
+                if (slot.group_id == group_id) return &slot;
+            } else {
+                if (!first_free) first_free = &slot;
+                if (slot.state == kEmpty) break; // End of probe chain
+            }
+        }
+        return first_free;
+    }
+
+    bool loadFactorHigh() const {
+        return (occupied_ + 1) * 10 >= slots_.size() * 7;
+    }
+
+    void grow() {
+        std::vector<Slot> old = std::move(slots_);
+        slots_.assign(old.size() * 2, Slot{});
+        for (auto& slot : old) {
+            if (slot.state != kOccupied) continue;
+            Slot* dest = findSlot(slot.group_id);
+            *dest = std::move(slot);
+        }
+    }
+
+    // Evicts the least-recently-touched group other than 'protect_id'.
+    // Returns false when there is nothing evictable.
+    bool evictStalest(uint32_t protect_id) {
+        Slot* victim = nullptr;
+        for (auto& slot : slots_) {
+            if (slot.state != kOccupied || slot.group_id == protect_id) continue;
+            if (!victim || slot.last_touch < victim->last_touch) victim = &slot;
+        }
+        if (!victim) return false;
+        uint32_t victim_id = victim->group_id;
+        size_t victim_bytes = victim->bytes;
+        AppPacketGroup group = std::move(victim->group);
+        releaseSlot(*victim);
+        if (on_evict_) {
+            on_evict_(victim_id, std::move(group), victim_bytes);
+        }
+        return true;
+    }
+
+    void releaseSlot(Slot& slot) {
+        total_bytes_ -= slot.bytes;
+        slot.bytes = 0;
+        slot.deadline_ns = 0;
+        slot.state = kTombstone;
+        recycle(std::move(slot.group));
+        --occupied_;
+    }
+
+    std::vector<uint32_t>& wheelBucket(uint64_t deadline_ns) {
+        return wheel_[static_cast<size_t>(deadline_ns >> kSliceShiftNs) & (kWheelSlots - 1)];
+    }
+
+    AppPacketGroup takeRecycledGroup() {
+        if (!free_groups_.empty()) {
+            AppPacketGroup group = std::move(free_groups_.back());
+            free_groups_.pop_back();
+            return group;
+        }
+        AppPacketGroup group;
+        group.reserve(4);
+        return group;
+    }
+
+    static const size_t kMaxFreeGroups = 16;
+
+    // Hashed timer wheel: 64 buckets of ~134ms slices (~8.6s per lap).
+    // Deadlines beyond one lap stay filed in their bucket and survive sweeps
+    // via the deadline check until their rotation comes around.
+    static const size_t kWheelSlots = 64;       // Power of two
+    static const uint64_t kSliceShiftNs = 27;   // 2^27 ns ~ 134ms per slice
+
+    size_t max_groups_;
+    size_t max_bytes_;
+    EvictionCallback on_evict_;
+    std::vector<Slot> slots_;
+    std::vector<AppPacketGroup> free_groups_;
+    std::array<std::vector<uint32_t>, kWheelSlots> wheel_;
+    size_t occupied_ = 0;
+    size_t total_bytes_ = 0;
+    uint64_t touch_counter_ = 0;
+    uint64_t timeout_ns_ = 0;       // 0 = timeouts disabled
+    uint64_t sweep_cursor_ = 0;     // Last fully swept slice (absolute index)
+    uint64_t timed_out_groups_ = 0; // Exported for monitoring
+};
+
+} // namespace BPG
+
+#endif // BPG_GROUP_TABLE_H
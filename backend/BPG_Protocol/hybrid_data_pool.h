@@ -0,0 +1,146 @@
+#pragma once
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "bpg_types.h"
+
+namespace BPG {
+
+// --- Recycling pool for AppPacket content objects ---
+// Every decoded and every sent packet used to make_shared a fresh HybridData
+// whose byte vector was heap-grown from zero - constant churn at thousands
+// of packets per second. The pool hands out recycled objects from a free
+// list instead: recycleReset() clears them WITHOUT freeing their string and
+// vector buffers, so steady-state parse/encode runs inside capacity that
+// was allocated long ago.
+//
+// acquire() returns a shared_ptr whose deleter puts the object back on the
+// free list when the last reference drops, so call sites treat it exactly
+// like make_shared<T>(). The shared_ptr control block is recycled too (they
+// are all the same size for a given T, so a second free list covers them),
+// making a warm acquire()/release cycle fully allocation-free.
+//
+// The deleter captures the pool raw, so pools must outlive every object
+// they hand out - INCLUDING objects parked in other statics whose
+// destructors run in an order the pool cannot see. Shared pools should be
+// intentionally leaked heap singletons (see hybridDataPool() below) so no
+// destruction order can violate this.
+template <typename T = HybridData>
+class HybridDataPool {
+public:
+    // 'max_free' bounds how many idle objects (and their retained payload
+    // capacity) the free list may pin.
+    explicit HybridDataPool(size_t max_free = 64) : max_free_(max_free) {}
+
+    HybridDataPool(const HybridDataPool&) = delete;
+    HybridDataPool& operator=(const HybridDataPool&) = delete;
+
+    ~HybridDataPool() {
+        for (T* obj : free_list_) delete obj;
+        for (void* block : free_blocks_) ::operator delete(block);
+    }
+
+    std::shared_ptr<T> acquire() {
+        T* obj = nullptr;
+        {
+            std::lock_guard<std::mutex> lock(mtx_);
+            if (!free_list_.empty()) {
+                obj = free_list_.back();
+                free_list_.pop_back();
+            }
+        }
+        if (!obj) obj = new T();
+        // The allocator argument routes the control block through the pool's
+        // block free list (all control blocks for this signature are the
+        // same size), so a warm acquire performs no heap allocation at all.
+        return std::shared_ptr<T>(obj, [this](T* p) { recycle(p); },
+                                  CtrlBlockAlloc<T>(this));
+    }
+
+    size_t freeCount() {
+        std::lock_guard<std::mutex> lock(mtx_);
+        return free_list_.size();
+    }
+
+private:
+    // Allocator used ONLY for shared_ptr control blocks; shared_ptr rebinds
+    // it to its internal control-block type, whose size is recorded on first
+    // use and recycled through free_blocks_ thereafter.
+    template <typename U>
+    struct CtrlBlockAlloc {
+        using value_type = U;
+        HybridDataPool* pool;
+        explicit CtrlBlockAlloc(HybridDataPool* p) : pool(p) {}
+        template <typename V>
+        CtrlBlockAlloc(const CtrlBlockAlloc<V>& other) : pool(other.pool) {}
+        U* allocate(size_t n) {
+            return static_cast<U*>(pool->allocBlock(n * sizeof(U)));
+        }
+        void deallocate(U* p, size_t n) {
+            pool->freeBlock(p, n * sizeof(U));
+        }
+        template <typename V>
+        bool operator==(const CtrlBlockAlloc<V>& other) const { return pool == other.pool; }
+        template <typename V>
+        bool operator!=(const CtrlBlockAlloc<V>& other) const { return pool != other.pool; }
+    };
+
+    void* allocBlock(size_t size) {
+        {
+            std::lock_guard<std::mutex> lock(mtx_);
+            if (block_size_ == 0) block_size_ = size;
+            if (size == block_size_ && !free_blocks_.empty()) {
+                void* block = free_blocks_.back();
+                free_blocks_.pop_back();
+                return block;
+            }
+        }
+        return ::operator new(size);
+    }
+
+    void freeBlock(void* block, size_t size) {
+        {
+            std::lock_guard<std::mutex> lock(mtx_);
+            if (size == block_size_ && free_blocks_.size() < max_free_) {
+                free_blocks_.push_back(block);
+                return;
+            }
+        }
+        ::operator delete(block); // Wrong size or list full - outside the lock
+    }
+
+    void recycle(T* obj) {
+        obj->recycleReset();
+        {
+            std::lock_guard<std::mutex> lock(mtx_);
+            if (free_list_.size() < max_free_) {
+                free_list_.push_back(obj);
+                return;
+            }
+        }
+        delete obj; // Free list full - outside the lock
+    }
+
+    std::mutex mtx_;
+    std::vector<T*> free_list_;
+    std::vector<void*> free_blocks_; // Recycled shared_ptr control blocks
+    size_t block_size_ = 0;          // Control-block size, fixed per T
+    size_t max_free_;
+};
+
+// Shared pool for plain HybridData content - used by the decoder for every
+// parsed packet and by string-packet factories on the send side.
+// Intentionally leaked: the function-local static is constructed lazily
+// (first decode), so a destructor-ordered teardown would destroy it BEFORE
+// earlier-constructed statics (decoders with buffered groups, thread-local
+// builders) drop their pooled objects - whose deleters would then touch a
+// dead pool. Leaking removes that ordering hazard; the process is exiting
+// anyway.
+inline HybridDataPool<HybridData>& hybridDataPool() {
+    static HybridDataPool<HybridData>* pool = new HybridDataPool<HybridData>();
+    return *pool;
+}
+
+} // namespace BPG
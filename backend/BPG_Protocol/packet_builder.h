@@ -0,0 +1,69 @@
+#pragma once
+
+#include "bpg_types.h"
+#include "hybrid_data_pool.h"
+#include <cstring>
+#include <utility>
+
+namespace BPG {
+
+// --- GroupBuilder: reusable outbound packet-group composer ---
+// Owns the AppPacketGroup it hands out, so the vector's capacity (and, via
+// the content pool, each packet's string/vector capacities) survives from
+// frame to frame: after the first few groups, composing a group performs no
+// heap allocations. Usage:
+//
+//   builder.begin(group_id, target_id, /*expected_packets=*/2);
+//   AppPacket& im = builder.add("IM", pool.acquire());
+//   ... fill im.content (beginMetadata/commitMetadata, payload by move/view)
+//   AppPacket& ak = builder.add("AK");
+//   send_packet_group(builder.finish());   // Marks the last packet EG
+//
+// Not thread-safe: give each sending thread its own builder (thread_local at
+// the call site). finish()'s group stays valid until the next begin().
+class GroupBuilder {
+public:
+    // Starts a new group, dropping the previous one (its pooled contents are
+    // recycled here). 'expected_packets' reserves the vector up front so
+    // add() never reallocates mid-group.
+    GroupBuilder& begin(uint32_t group_id, uint32_t target_id, size_t expected_packets) {
+        group_.clear();
+        group_.reserve(expected_packets);
+        group_id_ = group_id;
+        target_id_ = target_id;
+        return *this;
+    }
+
+    // Appends a packet carrying 'content' (typically from a HybridDataPool;
+    // taken by move, no refcount churn) and returns it for filling in.
+    AppPacket& add(const char* tl, std::shared_ptr<HybridData> content) {
+        group_.emplace_back();
+        AppPacket& packet = group_.back();
+        packet.group_id = group_id_;
+        packet.target_id = target_id_;
+        std::memcpy(packet.tl, tl, sizeof(PacketType));
+        packet.is_end_of_group = false;
+        packet.content = std::move(content);
+        return packet;
+    }
+
+    // Convenience overload drawing from the shared base-HybridData pool.
+    AppPacket& add(const char* tl) {
+        return add(tl, hybridDataPool().acquire());
+    }
+
+    // Flags the final packet as end-of-group and returns the finished group.
+    AppPacketGroup& finish() {
+        if (!group_.empty()) group_.back().is_end_of_group = true;
+        return group_;
+    }
+
+    size_t size() const { return group_.size(); }
+
+private:
+    AppPacketGroup group_;
+    uint32_t group_id_ = 0;
+    uint32_t target_id_ = 0;
+};
+
+} // namespace BPG
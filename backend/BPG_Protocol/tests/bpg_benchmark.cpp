@@ -0,0 +1,213 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include <cstring>
+#include <chrono>
+#include <algorithm>
+#include <iomanip>
+#include <random>
+#include "../bpg_encoder.h"
+#include "../bpg_decoder.h"
+#include "../bpg_types.h"
+
+// --- BPG encode/decode benchmark ---
+// Measures AppPacket::encode / HybridData::encode and BpgDecoder::processData
+// across a matrix of payload sizes, group sizes and fragmentation patterns,
+// reporting throughput (GB/s) and per-packet latency percentiles (p50/p99).
+// Intended as a release gate: run before/after protocol changes and compare.
+
+using Clock = std::chrono::steady_clock;
+
+struct LatencyStats {
+    double p50_us;
+    double p99_us;
+    double max_us;
+};
+
+static LatencyStats computeStats(std::vector<double>& samples_us) {
+    LatencyStats s{0, 0, 0};
+    if (samples_us.empty()) return s;
+    std::sort(samples_us.begin(), samples_us.end());
+    s.p50_us = samples_us[samples_us.size() / 2];
+    s.p99_us = samples_us[std::min(samples_us.size() - 1, (samples_us.size() * 99) / 100)];
+    s.max_us = samples_us.back();
+    return s;
+}
+
+// Builds a group of 'group_size' packets, each carrying 'payload_size' bytes
+// of binary payload plus a small metadata string (the shape our image groups
+// have on the wire).
+static BPG::AppPacketGroup makeGroup(uint32_t group_id, size_t payload_size, size_t group_size,
+                                     const std::vector<uint8_t>& payload_src) {
+    BPG::AppPacketGroup group;
+    group.reserve(group_size);
+    for (size_t i = 0; i < group_size; ++i) {
+        BPG::AppPacket packet;
+        packet.group_id = group_id;
+        packet.target_id = 1;
+        std::memcpy(packet.tl, (i + 1 == group_size) ? "AK" : "IM", 2);
+        packet.is_end_of_group = (i + 1 == group_size);
+        auto content = std::make_shared<BPG::HybridData>();
+        content->metadata_str = "{\"bench\":true,\"i\":" + std::to_string(i) + "}";
+        content->internal_binary_bytes.assign(payload_src.begin(), payload_src.begin() + payload_size);
+        packet.content = content;
+        group.push_back(std::move(packet));
+    }
+    return group;
+}
+
+static size_t encodedGroupSize(const BPG::AppPacketGroup& group) {
+    size_t total = 0;
+    for (const auto& packet : group) {
+        total += BPG::BPG_HEADER_SIZE + (packet.content ? packet.content->calculateEncodedSize() : 0);
+    }
+    return total;
+}
+
+// Fragmentation patterns fed into BpgDecoder::processData
+enum class Fragmentation { Whole, Chunk4K, ByteDribble };
+
+static const char* fragName(Fragmentation f) {
+    switch (f) {
+        case Fragmentation::Whole:       return "whole";
+        case Fragmentation::Chunk4K:     return "chunk4k";
+        case Fragmentation::ByteDribble: return "dribble";
+    }
+    return "?";
+}
+
+struct BenchResult {
+    double encode_gbps;
+    LatencyStats encode_lat;
+    double decode_gbps;
+    LatencyStats decode_lat;
+};
+
+static BenchResult runCase(size_t payload_size, size_t group_size, Fragmentation frag,
+                           size_t iterations, const std::vector<uint8_t>& payload_src) {
+    BenchResult result{};
+
+    BPG::AppPacketGroup group = makeGroup(1, payload_size, group_size, payload_src);
+    size_t wire_size = encodedGroupSize(group);
+    std::vector<uint8_t> wire_buffer(wire_size);
+
+    // --- Encode pass ---
+    std::vector<double> encode_samples;
+    encode_samples.reserve(iterations * group_size);
+    auto encode_start = Clock::now();
+    for (size_t it = 0; it < iterations; ++it) {
+        BPG::BufferWriter writer(wire_buffer.data(), wire_buffer.size());
+        for (const auto& packet : group) {
+            auto t0 = Clock::now();
+            BPG::BpgError err = packet.encode(writer);
+            auto t1 = Clock::now();
+            if (err != BPG::BpgError::Success) {
+                std::cerr << "Encode error: " << static_cast<int>(err) << std::endl;
+                return result;
+            }
+            encode_samples.push_back(std::chrono::duration<double, std::micro>(t1 - t0).count());
+        }
+    }
+    double encode_seconds = std::chrono::duration<double>(Clock::now() - encode_start).count();
+    result.encode_gbps = (double)(wire_size * iterations) / encode_seconds / 1e9;
+    result.encode_lat = computeStats(encode_samples);
+
+    // --- Decode pass ---
+    size_t packets_decoded = 0;
+    size_t groups_decoded = 0;
+    BPG::BpgDecoder decoder;
+    std::vector<double> decode_samples;
+    decode_samples.reserve(iterations);
+
+    auto packet_cb = [&](const BPG::AppPacket&) { ++packets_decoded; };
+    auto group_cb = [&](uint32_t, BPG::AppPacketGroup&&) { ++groups_decoded; };
+
+    auto decode_start = Clock::now();
+    for (size_t it = 0; it < iterations; ++it) {
+        auto t0 = Clock::now();
+        switch (frag) {
+            case Fragmentation::Whole:
+                decoder.processData(wire_buffer.data(), wire_size, packet_cb, group_cb);
+                break;
+            case Fragmentation::Chunk4K: {
+                for (size_t off = 0; off < wire_size; off += 4096) {
+                    size_t n = std::min((size_t)4096, wire_size - off);
+                    decoder.processData(wire_buffer.data() + off, n, packet_cb, group_cb);
+                }
+                break;
+            }
+            case Fragmentation::ByteDribble: {
+                for (size_t off = 0; off < wire_size; ++off) {
+                    decoder.processData(wire_buffer.data() + off, 1, packet_cb, group_cb);
+                }
+                break;
+            }
+        }
+        auto t1 = Clock::now();
+        decode_samples.push_back(std::chrono::duration<double, std::micro>(t1 - t0).count());
+    }
+    double decode_seconds = std::chrono::duration<double>(Clock::now() - decode_start).count();
+    result.decode_gbps = (double)(wire_size * iterations) / decode_seconds / 1e9;
+    result.decode_lat = computeStats(decode_samples);
+
+    if (packets_decoded != iterations * group_size || groups_decoded != iterations) {
+        std::cerr << "VERIFY FAILED: packets=" << packets_decoded << " (expected " << iterations * group_size
+                  << "), groups=" << groups_decoded << " (expected " << iterations << ")" << std::endl;
+    }
+    return result;
+}
+
+int main(int argc, char** argv) {
+    // Optional iteration scale factor for quick local runs vs. gate runs
+    double scale = (argc > 1) ? std::atof(argv[1]) : 1.0;
+    if (scale <= 0) scale = 1.0;
+
+    // Deterministic pseudo-random payload (compressibility is irrelevant here,
+    // but a fixed pattern keeps runs comparable)
+    std::vector<uint8_t> payload_src(8 * 1024 * 1024);
+    std::mt19937 rng(12345);
+    for (auto& b : payload_src) b = static_cast<uint8_t>(rng());
+
+    const size_t payload_sizes[] = { 64, 4 * 1024, 64 * 1024, 1024 * 1024, 8 * 1024 * 1024 };
+    const size_t group_sizes[] = { 1, 4, 16 };
+    const Fragmentation frags[] = { Fragmentation::Whole, Fragmentation::Chunk4K, Fragmentation::ByteDribble };
+
+    std::cout << std::left
+              << std::setw(10) << "payload"
+              << std::setw(7)  << "group"
+              << std::setw(9)  << "frag"
+              << std::setw(11) << "enc GB/s"
+              << std::setw(11) << "enc p50us"
+              << std::setw(11) << "enc p99us"
+              << std::setw(11) << "dec GB/s"
+              << std::setw(11) << "dec p50us"
+              << std::setw(11) << "dec p99us"
+              << std::endl;
+
+    for (size_t payload_size : payload_sizes) {
+        for (size_t group_size : group_sizes) {
+            for (Fragmentation frag : frags) {
+                // Byte-dribble on multi-MB payloads would take minutes; cap it
+                if (frag == Fragmentation::ByteDribble && payload_size > 64 * 1024) continue;
+                // Keep total bytes per case roughly constant
+                size_t total_bytes_target = (size_t)(256.0 * 1024 * 1024 * scale);
+                size_t iterations = std::max((size_t)3, total_bytes_target / std::max((size_t)1, payload_size * group_size));
+                if (frag == Fragmentation::ByteDribble) iterations = std::min(iterations, (size_t)20);
+
+                BenchResult r = runCase(payload_size, group_size, frag, iterations, payload_src);
+                std::cout << std::left << std::fixed << std::setprecision(3)
+                          << std::setw(10) << payload_size
+                          << std::setw(7)  << group_size
+                          << std::setw(9)  << fragName(frag)
+                          << std::setw(11) << r.encode_gbps
+                          << std::setw(11) << r.encode_lat.p50_us
+                          << std::setw(11) << r.encode_lat.p99_us
+                          << std::setw(11) << r.decode_gbps
+                          << std::setw(11) << r.decode_lat.p50_us
+                          << std::setw(11) << r.decode_lat.p99_us
+                          << std::endl;
+            }
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,135 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <arpa/inet.h> // htonl/ntohl for the fixed u32 fields
+
+#include "buffer_writer.h"
+
+namespace BPG {
+
+// --- Binary TLV metadata sidecar ---
+// Hot-path packets ("IM" image frames at 30fps) used to carry their
+// geometry as ad-hoc JSON in HybridData::metadata_str: string formatting on
+// every send and a full DOM parse (one malloc per node under cJSON /
+// JSON.parse garbage on the renderer) on every receive, for a schema that
+// never changes. This encodes the same well-known keys as tagged
+// fixed-size fields instead, readable with a linear scan and zero
+// allocation.
+//
+// Wire format, one field after another:
+//   tag(1 byte) + value
+// Tags with the high bit CLEAR carry a fixed 4-byte big-endian uint32.
+// Tags with the high bit SET carry a 1-byte length followed by that many
+// bytes. Unknown tags are therefore skippable, so either side may add keys
+// without breaking the other.
+//
+// Whether a packet's metadata bytes are TLV or JSON travels in the packet
+// header: AppPacket::encode sets BPG_PROP_TLV_META_BIT_MASK in 'prop' when
+// the content is flagged (HybridData::metadata_is_tlv), and the decoder
+// re-raises the flag on the parsed content. JSON remains the default for
+// low-rate and debug traffic - nothing changes for packets without the bit.
+
+// Well-known keys. Values above 0x80 are length-prefixed (see above);
+// keep new fixed-u32 keys below it.
+enum TlvKey : uint8_t {
+    TLV_KEY_WIDTH      = 0x01, // u32: image width in pixels
+    TLV_KEY_HEIGHT     = 0x02, // u32: image height in pixels
+    TLV_KEY_CHANNELS   = 0x03, // u32: channel count
+    TLV_KEY_PIXEL_TYPE = 0x04, // u32: cv::Mat type() value
+    TLV_KEY_REQUEST_ID = 0x05, // u32: request correlation id
+    TLV_KEY_SLOT       = 0x06, // u32: frame-ring slot index (frame_ring.h)
+    TLV_KEY_GENERATION = 0x07, // u32: frame-ring slot generation
+    TLV_KEY_FORMAT     = 0x81  // string: payload encoding ("raw_rgba", "jpg", ...)
+};
+
+constexpr uint8_t TLV_STRING_TAG_BIT = 0x80;
+constexpr size_t TLV_U32_FIELD_SIZE = 1 + sizeof(uint32_t); // tag + value
+constexpr size_t TLV_MAX_STRING_LEN = 255;                  // 1-byte length prefix
+
+// Serializes TLV fields into a BufferWriter - typically one returned by
+// HybridData::beginMetadata(), so the sidecar lands directly in the pooled
+// metadata storage. All appends return false when out of space.
+class TlvMetaWriter {
+public:
+    explicit TlvMetaWriter(BufferWriter& out) : out_(out) {}
+
+    bool addU32(TlvKey key, uint32_t value) {
+        uint8_t tag = static_cast<uint8_t>(key);
+        if (!out_.canWrite(TLV_U32_FIELD_SIZE)) return false;
+        out_.append(&tag, 1);
+        return out_.append_uint32_network(value);
+    }
+
+    bool addString(TlvKey key, const char* str, size_t len) {
+        uint8_t tag = static_cast<uint8_t>(key);
+        if (!(tag & TLV_STRING_TAG_BIT) || len > TLV_MAX_STRING_LEN) return false;
+        if (!out_.canWrite(2 + len)) return false;
+        uint8_t len_byte = static_cast<uint8_t>(len);
+        out_.append(&tag, 1);
+        out_.append(&len_byte, 1);
+        return out_.append(str, len);
+    }
+
+    // Convenience for NUL-terminated literals
+    bool addString(TlvKey key, const char* str) {
+        return addString(key, str, std::strlen(str));
+    }
+
+private:
+    BufferWriter& out_;
+};
+
+// Non-owning reader over TLV metadata bytes (e.g. metadata_str of a packet
+// whose header carried BPG_PROP_TLV_META_BIT_MASK). Each find is a linear
+// scan - metadata is a handful of fields - and performs no allocation;
+// strings come back as a (pointer, length) into the scanned bytes.
+class TlvMetaReader {
+public:
+    TlvMetaReader(const void* data, size_t len)
+        : data_(static_cast<const uint8_t*>(data)), len_(len) {}
+
+    bool findU32(TlvKey key, uint32_t& out) const {
+        const uint8_t* field = find(key);
+        if (!field) return false;
+        uint32_t value_n;
+        std::memcpy(&value_n, field + 1, sizeof(value_n));
+        out = ntohl(value_n);
+        return true;
+    }
+
+    bool findString(TlvKey key, const char*& out_str, size_t& out_len) const {
+        const uint8_t* field = find(key);
+        if (!field) return false;
+        out_len = field[1];
+        out_str = reinterpret_cast<const char*>(field + 2);
+        return true;
+    }
+
+private:
+    // Returns a pointer to the tag byte of the first complete field with
+    // 'key', or nullptr. Truncated trailing fields are ignored.
+    const uint8_t* find(TlvKey key) const {
+        size_t pos = 0;
+        while (pos < len_) {
+            uint8_t tag = data_[pos];
+            size_t field_size;
+            if (tag & TLV_STRING_TAG_BIT) {
+                if (pos + 2 > len_) return nullptr;
+                field_size = 2 + data_[pos + 1];
+            } else {
+                field_size = TLV_U32_FIELD_SIZE;
+            }
+            if (pos + field_size > len_) return nullptr;
+            if (tag == static_cast<uint8_t>(key)) return data_ + pos;
+            pos += field_size;
+        }
+        return nullptr;
+    }
+
+    const uint8_t* data_;
+    size_t len_;
+};
+
+} // namespace BPG
@@ -0,0 +1,120 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// --- Shared frame ring (plugin-side writer) ---
+// The highest-bandwidth path used to re-encode every frame into the BPG
+// stream (header + payload memcpy through the SharedArrayBuffer transfer
+// region) even when the renderer only wants "latest frame". The ring turns
+// that into in-place pixel writes: the host hands the plugin N fixed slots
+// of renderer-visible shared memory (FrameRingRequestCallback, plugin API
+// v2), the plugin writes the newest frame into the next slot and announces
+// (slot index, generation) in a tiny constant-size BPG packet, and stale
+// frames are simply overwritten - a slow renderer skips frames for free
+// instead of backing up the transport.
+//
+// Each slot starts with a 32-byte SlotHeader whose 'generation' field is a
+// seqlock: the writer bumps it to an ODD value before touching the slot and
+// to the next EVEN value after, so a reader that sees an odd value - or a
+// different value after copying the pixels than before - knows the read was
+// torn and retries or skips. Generations are per slot and monotonic; the
+// value announced in the notification packet matching the slot header tells
+// the renderer the frame it was told about is still the one in the slot.
+//
+// The layout is mirrored by the renderer (frontend/src/lib/FrameRing.ts);
+// keep the two in sync.
+namespace frame_ring {
+
+// Per-slot header, followed immediately by the frame bytes.
+struct SlotHeader {
+    std::atomic<uint32_t> generation; // Seqlock: odd while the writer is in the slot
+    uint32_t width;
+    uint32_t height;
+    uint32_t pixel_type;              // cv::Mat type() value of the written pixels
+    uint32_t data_size;               // Frame bytes following this header
+    uint32_t reserved[3];
+};
+static_assert(sizeof(SlotHeader) == 32, "SlotHeader layout is shared with the renderer");
+static_assert(std::atomic<uint32_t>::is_always_lock_free,
+              "seqlock generation must be lock-free in shared memory");
+
+// What publish() returns - the contents of the notification packet.
+struct Publication {
+    uint32_t slot;
+    uint32_t generation;
+};
+
+// Writes frames round-robin into a host-provided ring region. Single
+// writer; attach() before use, every frame is a beginFrame()/publish()
+// pair. Not thread-safe - frames come from one producer.
+class FrameRingWriter {
+public:
+    // Takes ownership of nothing: 'base' is host-managed shared memory
+    // holding 'slot_count' slots of 'slot_size' bytes each. Zeroes the slot
+    // headers (generation 0 = never written).
+    bool attach(uint8_t* base, uint32_t slot_count, uint32_t slot_size) {
+        if (!base || slot_count == 0 || slot_size <= sizeof(SlotHeader)) return false;
+        base_ = base;
+        slot_count_ = slot_count;
+        slot_size_ = slot_size;
+        next_slot_ = 0;
+        for (uint32_t i = 0; i < slot_count_; ++i) {
+            SlotHeader* header = slotHeader(i);
+            header->generation.store(0, std::memory_order_relaxed);
+            header->width = header->height = header->pixel_type = header->data_size = 0;
+        }
+        return true;
+    }
+
+    bool active() const { return base_ != nullptr; }
+
+    // Largest frame a slot can hold.
+    size_t maxFrameBytes() const {
+        return active() ? slot_size_ - sizeof(SlotHeader) : 0;
+    }
+
+    // Opens the next slot for writing and returns the pixel destination, or
+    // nullptr when inactive or the frame does not fit (caller falls back to
+    // the inline send path). The slot's generation goes odd until publish().
+    uint8_t* beginFrame(size_t data_size) {
+        if (!active() || data_size > maxFrameBytes()) return nullptr;
+        write_slot_ = next_slot_;
+        next_slot_ = (next_slot_ + 1) % slot_count_;
+        SlotHeader* header = slotHeader(write_slot_);
+        uint32_t gen = header->generation.load(std::memory_order_relaxed);
+        header->generation.store(gen + 1, std::memory_order_relaxed); // Odd: in progress
+        std::atomic_thread_fence(std::memory_order_release);
+        pending_size_ = data_size;
+        return reinterpret_cast<uint8_t*>(header + 1);
+    }
+
+    // Seals the slot opened by beginFrame(): fills the header fields and
+    // closes the seqlock (next even generation). The return value is what
+    // the notification packet carries.
+    Publication publish(uint32_t width, uint32_t height, uint32_t pixel_type) {
+        SlotHeader* header = slotHeader(write_slot_);
+        header->width = width;
+        header->height = height;
+        header->pixel_type = pixel_type;
+        header->data_size = static_cast<uint32_t>(pending_size_);
+        uint32_t gen = header->generation.load(std::memory_order_relaxed) + 1; // Even: done
+        header->generation.store(gen, std::memory_order_release);
+        return Publication{write_slot_, gen};
+    }
+
+private:
+    SlotHeader* slotHeader(uint32_t slot) const {
+        return reinterpret_cast<SlotHeader*>(base_ + static_cast<size_t>(slot) * slot_size_);
+    }
+
+    uint8_t* base_ = nullptr;
+    uint32_t slot_count_ = 0;
+    uint32_t slot_size_ = 0;
+    uint32_t next_slot_ = 0;
+    uint32_t write_slot_ = 0;
+    size_t pending_size_ = 0;
+};
+
+} // namespace frame_ring
@@ -50,6 +50,7 @@ typedef int (*ITPIF_DispatchFunc)(void* main_ctx,struct ITPIF_StageInfo_c* data)
 typedef cJSON* (*ITPIF_GetGlobalValueFunc)(void* main_ctx);
 typedef void (*ITPIF_UnlockGlobalValueFunc)(void* main_ctx);
 typedef ITPIF_ImageInfo (*ITPIF_RequestImgFunc)(void* main_ctx,int width, int height, int channels, int type);
+typedef void (*ITPIF_ReleaseImgFunc)(void* main_ctx, ITPIF_ImageInfo* img);
 typedef ITPIF_StageInfo_c (*ITPIF_RequestStageInfoFunc)(void* main_ctx);
 
 typedef struct ITPIF_ManagerInterface {
@@ -57,6 +58,9 @@ typedef struct ITPIF_ManagerInterface {
     ITPIF_GetGlobalValueFunc getNLockGlobalValue;
     ITPIF_UnlockGlobalValueFunc unLockGlobalValue;
     ITPIF_RequestImgFunc requestImg;
+    // Returns a buffer obtained from requestImg to the host's pool. After the
+    // call the ImageInfo's buffer must not be touched by the plugin anymore.
+    ITPIF_ReleaseImgFunc releaseImg;
     ITPIF_RequestStageInfoFunc requestStageInfo;
 } ITPIF_ManagerInterface;
 
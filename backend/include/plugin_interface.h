@@ -9,7 +9,9 @@ extern "C" {
 #include <stddef.h>
 
 // Plugin API version
-#define PLUGIN_API_VERSION 1
+// v2: adds the optional shared frame ring (setup_frame_ring at the end of
+// PluginInterface - v1 hosts simply never call it)
+#define PLUGIN_API_VERSION 2
 
 // Plugin initialization status
 typedef enum {
@@ -32,6 +34,14 @@ typedef int (*BufferRequestCallback)(uint32_t wait_ms,uint8_t** buffer, uint32_t
 
 typedef int (*BufferSendCallback)(uint32_t data_length);
 
+// Shared frame ring (API v2): the host carves 'slot_count' fixed slots of
+// 'slot_size' bytes each out of renderer-visible shared memory and returns
+// the region base via 'ring_base'. Returns 0 on success, non-zero if the
+// host cannot provide the region (the plugin then keeps sending frames
+// inline through the buffer callbacks). Slot layout and the generation
+// protocol live in frame_ring.h.
+typedef int (*FrameRingRequestCallback)(uint32_t slot_count, uint32_t slot_size, uint8_t** ring_base);
+
 
 // Plugin interface
 typedef struct {
@@ -52,6 +62,13 @@ typedef struct {
     
     // Called periodically by the host
     void (*update)();
+
+    // Optional, API v2: called once after initialize() by hosts that can
+    // expose a shared frame ring. Plugins that do not publish frames may set
+    // this to NULL; v1 hosts never call it and the plugin must fall back to
+    // inline frame sends. Hosts must check info.api_version >= 2 before
+    // reading this field.
+    PluginStatus (*setup_frame_ring)(FrameRingRequestCallback ring_request);
 } PluginInterface;
 
 // Plugin entry point - must be implemented by each plugin
@@ -9,6 +9,8 @@
 #include <thread>
 #include <atomic>
 #include <chrono>
+#include <condition_variable>
+#include <algorithm>
 
 #include "InspTarPluginInterface.h" // Assuming this is in the include path set by parent CMake
 
@@ -19,19 +21,210 @@
     #define PLUGIN_EXPORT __attribute__((visibility("default")))
 #endif
 
+// --- Triple-buffered frame handoff (capture thread -> consumers) ---
+// One slot is being written, one holds the newest completed frame, one is
+// held by whoever is reading. The capture thread never blocks on a reader
+// and a reader never blocks on the sensor: acquire() swaps the ready slot
+// into the reader's ownership in microseconds. Drop policy is latest-wins -
+// if the ready frame is replaced before anyone takes it, it is counted in
+// 'dropped' and silently superseded.
+// Exactly ONE reader may hold a slot at a time; callers serialize on
+// PluginState::reader_mtx for as long as they use the returned Mat.
+struct FrameTripleBuffer {
+    cv::Mat slots[3];
+    double ts_ms[3] = {0, 0, 0};     // CAP_PROP_POS_MSEC at capture
+    uint64_t seq[3] = {0, 0, 0};     // Monotonic frame number
+
+    // Capture thread: retrieve into beginWrite(), then publish().
+    cv::Mat& beginWrite() { return slots[write_idx]; }
+    void publish(double timestamp_ms) {
+        std::lock_guard<std::mutex> lock(mtx);
+        seq[write_idx] = next_seq++;
+        ts_ms[write_idx] = timestamp_ms;
+        if (ready_fresh) ++dropped; // Previous ready frame was never taken
+        std::swap(write_idx, ready_idx);
+        ready_fresh = true;
+        cv.notify_all();
+    }
+
+    // Reader: waits up to wait_ms for a completed frame with seq > min_seq
+    // and takes its slot out of the writer's rotation. Returns the slot
+    // index, or -1 on timeout. The slot stays untouched by the capture
+    // thread until the holder's NEXT acquire() recycles it.
+    int acquire(uint64_t min_seq, int wait_ms) {
+        std::unique_lock<std::mutex> lock(mtx);
+        bool got = cv.wait_for(lock, std::chrono::milliseconds(wait_ms),
+            [&] { return ready_fresh && seq[ready_idx] > min_seq; });
+        if (!got) return -1;
+        std::swap(read_idx, ready_idx);
+        ready_fresh = false;
+        return read_idx;
+    }
+
+    uint64_t droppedCount() {
+        std::lock_guard<std::mutex> lock(mtx);
+        return dropped;
+    }
+
+private:
+    std::mutex mtx; // Guards index rotation only (held for microseconds)
+    std::condition_variable cv;
+    int write_idx = 0;
+    int ready_idx = 1;
+    int read_idx = 2;
+    bool ready_fresh = false;
+    uint64_t next_seq = 1;
+    uint64_t dropped = 0;
+};
+
 struct PluginState {
     cv::VideoCapture cap;
     ITPIF_ManagerInterface manager; // Copy of manager interface
     void* main_ctx = nullptr;       // Context from the manager/host
     std::string plugin_id;          // ID assigned to this plugin instance
     int plugin_pgID = 0;            // Placeholder for pgID used in communication
-    std::mutex mtx;
+    // Frames land here from the shared capture scheduler below; while the
+    // instance is registered, the scheduler's workers are the only users of
+    // 'cap', so commands never pay sensor exposure latency behind a lock.
+    FrameTripleBuffer frames;
+    std::mutex reader_mtx; // Serializes frame consumers (stream thread vs GET_FRAME)
     std::atomic<bool> streaming{false};
     std::thread stream_thread;
+    int camera_index = 0;
+    double req_fps = 30.0;
     int req_width = 640;
     int req_height = 480;
-    int req_channels = 3;
-    int req_type = CV_8UC3;
+    // RGBA so the renderer-bound conversion can target the wire buffer directly
+    int req_channels = 4;
+    int req_type = CV_8UC4;
+    cv::Mat resize_scratch; // Only touched by the stream thread
+};
+
+// --- Shared capture scheduler (one pool for all camera instances) ---
+// Rigs run 4-6 cameras; one free-running thread per camera meant N threads
+// all sleeping their own 33ms and bursting through manager.dispatch in the
+// same millisecond. Instead every instance registers its camera here: a
+// small worker pool services grabs by earliest deadline (each camera's
+// deadline advances by its own 1/fps period), and registration staggers
+// initial phases across the frame interval so captures - and therefore
+// downstream dispatches - are spread out instead of synchronized.
+class CaptureScheduler {
+public:
+    static CaptureScheduler& instance() {
+        static CaptureScheduler sched;
+        return sched;
+    }
+
+    void add(PluginState* state, double fps) {
+        std::lock_guard<std::mutex> lock(mtx_);
+        ScheduledCamera cam;
+        cam.state = state;
+        cam.period = std::chrono::nanoseconds(
+            (int64_t)(1e9 / (fps > 0.0 ? fps : 30.0)));
+        // Stagger: spread up to kStaggerSlots cameras across one period
+        cam.deadline = std::chrono::steady_clock::now()
+                     + cam.period * (int64_t)(registered_counter_ % kStaggerSlots) / (int64_t)kStaggerSlots;
+        ++registered_counter_;
+        cams_.push_back(cam);
+        if (workers_.empty()) {
+            running_ = true;
+            for (size_t i = 0; i < kWorkerCount; ++i) {
+                workers_.emplace_back([this] { workerLoop(); });
+            }
+        }
+        cv_.notify_all();
+    }
+
+    // Blocks until no worker is touching the camera, then unregisters it.
+    // Stops the pool when the last camera leaves.
+    void remove(PluginState* state) {
+        std::unique_lock<std::mutex> lock(mtx_);
+        for (;;) {
+            auto it = std::find_if(cams_.begin(), cams_.end(),
+                [&](const ScheduledCamera& c) { return c.state == state; });
+            if (it == cams_.end()) return;
+            if (!it->in_service) {
+                if (it->overruns > 0) {
+                    std::cout << "ImgSrc_Opencv_webcam [" << state->plugin_id << "]: "
+                              << it->overruns << " capture deadline overrun(s)." << std::endl;
+                }
+                cams_.erase(it);
+                break;
+            }
+            cv_.wait(lock);
+        }
+        if (cams_.empty()) {
+            running_ = false;
+            cv_.notify_all();
+            lock.unlock();
+            for (auto& w : workers_) {
+                if (w.joinable()) w.join();
+            }
+            workers_.clear();
+        }
+    }
+
+private:
+    static constexpr size_t kWorkerCount = 2;
+    static constexpr size_t kStaggerSlots = 8;
+
+    struct ScheduledCamera {
+        PluginState* state = nullptr;
+        std::chrono::steady_clock::time_point deadline;
+        std::chrono::nanoseconds period{0};
+        bool in_service = false; // A worker is inside grab/retrieve
+        uint64_t overruns = 0;   // Deadlines missed by more than a period
+    };
+
+    void workerLoop() {
+        std::unique_lock<std::mutex> lock(mtx_);
+        while (running_) {
+            auto now = std::chrono::steady_clock::now();
+            ScheduledCamera* pick = nullptr;
+            auto wake = now + std::chrono::milliseconds(100);
+            for (auto& c : cams_) {
+                if (c.in_service) continue;
+                if (c.deadline <= now && (!pick || c.deadline < pick->deadline)) pick = &c;
+                if (c.deadline < wake) wake = c.deadline;
+            }
+            if (!pick) {
+                cv_.wait_until(lock, wake);
+                continue;
+            }
+            pick->in_service = true;
+            // Deadline-based pacing: advance by the period; if we fell more
+            // than a period behind (slow sensor, saturated pool), resync to
+            // now rather than burst-capturing to catch up.
+            auto next = pick->deadline + pick->period;
+            if (next <= now) {
+                next = now + pick->period;
+                ++pick->overruns;
+            }
+            pick->deadline = next;
+            PluginState* s = pick->state;
+
+            lock.unlock();
+            if (s->cap.grab()) {
+                cv::Mat& slot = s->frames.beginWrite();
+                if (s->cap.retrieve(slot) && !slot.empty()) {
+                    s->frames.publish(s->cap.get(cv::CAP_PROP_POS_MSEC));
+                }
+            }
+            lock.lock();
+            // Re-locate by state: cams_ may have shifted while unlocked
+            for (auto& c : cams_) {
+                if (c.state == s) { c.in_service = false; break; }
+            }
+            cv_.notify_all();
+        }
+    }
+
+    std::mutex mtx_;
+    std::condition_variable cv_;
+    std::vector<ScheduledCamera> cams_;
+    std::vector<std::thread> workers_;
+    bool running_ = false;
+    size_t registered_counter_ = 0;
 };
 
 // --- Plugin Interface Implementation ---
@@ -50,12 +243,24 @@ void* CreatePluginInstance(const char *id, cJSON* def, const char *local_env_pat
     state->plugin_id = (id ? id : "");
     state->plugin_pgID = 0; // Placeholder
 
-    // Optional: Use 'def' or 'local_env_path' to configure camera index, resolution etc.
-    // cJSON* camera_index_item = cJSON_GetObjectItemCaseSensitive(def, "camera_index");
-    // int camera_index = (cJSON_IsNumber(camera_index_item)) ? camera_index_item->valueint : 0;
-    int camera_index = 0; // Default to 0
+    // Per-instance camera configuration from the 'def' JSON:
+    //   {"camera_index": 2, "width": 1280, "height": 720, "fps": 25}
+    // Anything missing falls back to the member defaults.
+    if (def) {
+        cJSON* item = cJSON_GetObjectItemCaseSensitive(def, "camera_index");
+        if (cJSON_IsNumber(item)) state->camera_index = item->valueint;
+        item = cJSON_GetObjectItemCaseSensitive(def, "width");
+        if (cJSON_IsNumber(item)) state->req_width = item->valueint;
+        item = cJSON_GetObjectItemCaseSensitive(def, "height");
+        if (cJSON_IsNumber(item)) state->req_height = item->valueint;
+        item = cJSON_GetObjectItemCaseSensitive(def, "fps");
+        if (cJSON_IsNumber(item) && item->valuedouble > 0) state->req_fps = item->valuedouble;
+    }
+    int camera_index = state->camera_index;
 
-    std::cout << "ImgSrc_Opencv_webcam [" << state->plugin_id << "]: Attempting to open webcam (index " << camera_index << ")..." << std::endl;
+    std::cout << "ImgSrc_Opencv_webcam [" << state->plugin_id << "]: Attempting to open webcam (index " << camera_index
+              << ", " << state->req_width << "x" << state->req_height
+              << " @ " << state->req_fps << "fps)..." << std::endl;
     state->cap.open(camera_index); // Open the specified camera
 
     if (!state->cap.isOpened()) {
@@ -65,12 +270,17 @@ void* CreatePluginInstance(const char *id, cJSON* def, const char *local_env_pat
     }
     std::cout << "ImgSrc_Opencv_webcam [" << state->plugin_id << "]: Webcam opened successfully." << std::endl;
 
+    // Ask the sensor for the configured geometry/rate (drivers may clamp)
+    state->cap.set(cv::CAP_PROP_FRAME_WIDTH, state->req_width);
+    state->cap.set(cv::CAP_PROP_FRAME_HEIGHT, state->req_height);
+    state->cap.set(cv::CAP_PROP_FPS, state->req_fps);
+
     // ensure streaming flags initialized
     state->streaming = false;
-    state->req_width = 640;
-    state->req_height = 480;
-    state->req_channels = 3;
-    state->req_type = CV_8UC3;
+
+    // Register with the shared capture scheduler; its workers own 'cap'
+    // from here until DestroyPluginInstance removes the instance.
+    CaptureScheduler::instance().add(state, state->req_fps);
 
     return static_cast<void*>(state);
 }
@@ -84,6 +294,11 @@ void DestroyPluginInstance(void* instance) {
         state->streaming = false;
         if (state->stream_thread.joinable()) state->stream_thread.join();
     }
+    // Unregister from the capture scheduler BEFORE releasing the camera its
+    // workers own (remove blocks until no worker is inside grab/retrieve)
+    CaptureScheduler::instance().remove(state);
+    std::cout << "ImgSrc_Opencv_webcam [" << state->plugin_id << "]: Dropped "
+              << state->frames.droppedCount() << " unconsumed frame(s) over the session." << std::endl;
     std::cout << "ImgSrc_Opencv_webcam [" << state->plugin_id << "]: Releasing webcam." << std::endl;
     if (state->cap.isOpened()) {
         state->cap.release();
@@ -132,7 +347,16 @@ int PluginExchangeCMD(void* instance, cJSON *info, int id, struct ITPIF_CMDActIn
         if (!state->streaming) {
             state->streaming = true;
             state->stream_thread = std::thread([state]() {
+                uint64_t last_seq = 0; // Last frame number dispatched
                 while (state->streaming) {
+                    // Pace off the camera's clock: block until the capture
+                    // thread publishes a frame newer than the last one we
+                    // sent (bounded so the streaming flag stays responsive).
+                    std::unique_lock<std::mutex> reader(state->reader_mtx);
+                    int slot = state->frames.acquire(last_seq, 100);
+                    if (slot < 0) continue; // Camera stalled, re-check flag
+                    last_seq = state->frames.seq[slot];
+
                     auto stage = state->manager.requestStageInfo(state->main_ctx);
                     auto imgInfo = state->manager.requestImg(
                         state->main_ctx,
@@ -141,9 +365,42 @@ int PluginExchangeCMD(void* instance, cJSON *info, int id, struct ITPIF_CMDActIn
                         state->req_channels,
                         state->req_type
                     );
-                    stage.img = imgInfo;
-                    state->manager.dispatch(state->main_ctx, &stage);
-                    std::this_thread::sleep_for(std::chrono::milliseconds(33));
+
+                    bool captured = false;
+                    if (imgInfo.buffer) {
+                        const cv::Mat& frame = state->frames.slots[slot];
+                        // Write the frame (resize/convert as needed) directly
+                        // into the buffer the host handed down. When the host
+                        // claimed the output wire buffer, this conversion IS
+                        // the delivery - no further copy happens downstream.
+                        cv::Mat dst(imgInfo.height, imgInfo.width, imgInfo.type,
+                                    imgInfo.buffer, (size_t)imgInfo.step);
+                        cv::Mat src = frame;
+                        if (src.cols != dst.cols || src.rows != dst.rows) {
+                            cv::resize(src, state->resize_scratch, dst.size());
+                            src = state->resize_scratch;
+                        }
+                        captured = true;
+                        if (imgInfo.channels == 4) {
+                            cv::cvtColor(src, dst, cv::COLOR_BGR2RGBA);
+                        } else if (imgInfo.channels == 3) {
+                            src.copyTo(dst);
+                        } else if (imgInfo.channels == 1) {
+                            cv::cvtColor(src, dst, cv::COLOR_BGR2GRAY);
+                        } else {
+                            captured = false;
+                        }
+                    }
+                    // Done reading the slot; let GET_FRAME in before dispatch
+                    reader.unlock();
+
+                    if (captured) {
+                        stage.img = imgInfo;
+                        state->manager.dispatch(state->main_ctx, &stage);
+                    } else if (state->manager.releaseImg) {
+                        // Hand the (possibly wire-backed) buffer straight back
+                        state->manager.releaseImg(state->main_ctx, &imgInfo);
+                    }
                 }
             });
         }
@@ -156,6 +413,8 @@ int PluginExchangeCMD(void* instance, cJSON *info, int id, struct ITPIF_CMDActIn
         if (state->streaming) {
             state->streaming = false;
             if (state->stream_thread.joinable()) state->stream_thread.join();
+            std::cout << "ImgSrc_Opencv_webcam [" << state->plugin_id << "]: Stream stopped ("
+                      << state->frames.droppedCount() << " frame(s) dropped so far)." << std::endl;
         }
         if (act.sendACK) {
             act.sendACK(state->plugin_pgID, 1, "{\"status\":\"STOP_STREAM_OK\"}");
@@ -164,16 +423,14 @@ int PluginExchangeCMD(void* instance, cJSON *info, int id, struct ITPIF_CMDActIn
     }
 
     if (strcmp(command, "GET_FRAME") == 0) {
-        cv::Mat frame;
-        bool success = false;
-        {
-            std::lock_guard<std::mutex> lock(state->mtx);
-            if (state->cap.isOpened()) {
-                success = state->cap.read(frame);
-            }
-        }
+        // Latest completed frame from the capture thread - no sensor wait
+        // here, only the slot swap (plus up to one frame interval right
+        // after startup or if the stream thread just took the ready slot).
+        std::lock_guard<std::mutex> reader(state->reader_mtx);
+        int slot = state->frames.acquire(0, 500);
 
-        if (success && !frame.empty()) {
+        if (slot >= 0) {
+            const cv::Mat& frame = state->frames.slots[slot];
             ITPIF_ImageInfo imgInfo = ITPIF_ImageInfoInit();
             imgInfo.buffer = frame.data;
             imgInfo.width = frame.cols;
@@ -13,6 +13,7 @@ import numpy as np
 import cv2 # Assuming OpenCV is still needed for processing
 import struct
 import fcntl
+import platform
 
 # --- Helper function to get hex preview of bytes (Python version) ---
 def bytesToHexPreview(bytes_data: bytes, max_bytes: int = 30) -> str:
@@ -76,22 +77,86 @@ except AttributeError:
      # Non-fatal, might still work but can't close FD
      c_close = None 
 
-# --- Shared Memory Structure Definition (Matches C++ Creator/Acceptor) --- 
+# Number of message slots per ring direction (must match SHM_RING_SLOT_COUNT in python_ipc.h)
+SHM_RING_SLOT_COUNT = 8
+
+# Size of the request id prefixed to every C->A message and echoed back in the
+# response (must match IPC_REQUEST_ID_SIZE in python_ipc.h)
+REQUEST_ID_SIZE = 4
+
+# --- Shared Memory Structure Definition (Matches C++ Creator/Acceptor) ---
+class ShmMsgRing(ctypes.Structure):
+    _fields_ = [
+        ("head", ctypes.c_uint64),  # Next sequence the producer publishes
+        ("tail", ctypes.c_uint64),  # Next sequence the consumer reads
+        ("slot_len", ctypes.c_uint64 * SHM_RING_SLOT_COUNT),
+        # Futex doorbells (see python_ipc.h): producer bumps data_doorbell,
+        # consumer bumps space_doorbell; waiters block on the sampled value.
+        ("data_doorbell", ctypes.c_uint32),
+        ("space_doorbell", ctypes.c_uint32),
+    ]
+
 class SharedIPCBidirectional(ctypes.Structure):
     _fields_ = [
-        # Creator -> Acceptor
-        ("c_to_a_command", ctypes.c_int32), 
-        ("c_to_a_data_len", ctypes.c_size_t),
-        # Acceptor -> Creator
-        ("a_to_c_status", ctypes.c_int32),  
-        ("a_to_c_data_len", ctypes.c_size_t),
-        # Defined sizes
-        ("defined_c2a_buffer_size", ctypes.c_size_t), 
+        ("c_to_a_command", ctypes.c_int32),  # 0: Idle, 99: Shutdown
+        ("a_to_c_status", ctypes.c_int32),   # 0: OK, -1: Acceptor error
+        # Readiness handshake: WE set this to 1 once mapped + layout checked
+        ("acceptor_ready", ctypes.c_int32),
+        ("_reserved0", ctypes.c_int32),      # Keeps the size_t fields 8-aligned
+        # Defined PER-SLOT sizes
+        ("defined_c2a_buffer_size", ctypes.c_size_t),
         ("defined_a2c_buffer_size", ctypes.c_size_t),
-        # Padding
-        ("_padding1", ctypes.c_char * (128 - ctypes.sizeof(ctypes.c_int32)*2 - ctypes.sizeof(ctypes.c_size_t)*4)),
+        ("ring_slot_count", ctypes.c_uint64),
+        ("c2a_ring", ShmMsgRing),
+        ("a2c_ring", ShmMsgRing),
+        # Padding to the fixed 256-byte control block
+        ("_padding1", ctypes.c_char * (256
+                                       - ctypes.sizeof(ctypes.c_int32)*4
+                                       - ctypes.sizeof(ctypes.c_size_t)*2
+                                       - ctypes.sizeof(ctypes.c_uint64)
+                                       - ctypes.sizeof(ShmMsgRing)*2)),
     ]
 
+# --- Futex wakeup helpers (Linux; everywhere else falls back to sleeping) ---
+FUTEX_WAIT = 0
+FUTEX_WAKE = 1
+# syscall numbers for the platforms we deploy on
+_SYS_FUTEX = {"x86_64": 202, "aarch64": 98, "arm64": 98}.get(platform.machine()) \
+    if sys.platform.startswith("linux") else None
+
+class _timespec(ctypes.Structure):
+    _fields_ = [("tv_sec", ctypes.c_long), ("tv_nsec", ctypes.c_long)]
+
+# A typed prototype is REQUIRED here: without argtypes, ctypes passes Python
+# ints as 32-bit c_int, silently truncating the 64-bit doorbell address. The
+# futex calls then fail with EFAULT - waits spin and wakes reach nobody -
+# degrading every message to the 100ms fallback bound (caught by ipc_benchmark).
+_c_futex = libc.syscall
+_c_futex.restype = ctypes.c_long
+_c_futex.argtypes = [ctypes.c_long, ctypes.c_void_p, ctypes.c_int,
+                     ctypes.c_uint32, ctypes.c_void_p, ctypes.c_void_p,
+                     ctypes.c_uint32]
+
+def doorbell_addr(ring, field_name):
+    """Absolute address of a doorbell word inside the mapped control block."""
+    return ctypes.addressof(ring) + getattr(type(ring), field_name).offset
+
+def doorbell_wait(ring, field_name, seen_value, timeout_s):
+    """Blocks until the doorbell differs from seen_value (bounded wait)."""
+    if _SYS_FUTEX is None:
+        time.sleep(min(timeout_s, 0.0005))
+        return
+    ts = _timespec(int(timeout_s), int((timeout_s % 1.0) * 1e9))
+    _c_futex(_SYS_FUTEX, doorbell_addr(ring, field_name), FUTEX_WAIT,
+             seen_value, ctypes.byref(ts), None, 0)
+
+def doorbell_ring(ring, field_name):
+    """Bumps the doorbell and wakes any waiters on it."""
+    setattr(ring, field_name, (getattr(ring, field_name) + 1) & 0xFFFFFFFF)
+    if _SYS_FUTEX is not None:
+        _c_futex(_SYS_FUTEX, doorbell_addr(ring, field_name), FUTEX_WAKE,
+                 0x7FFFFFFF, None, None, 0)
+
 # Global variables
 shm_fd = -1       
 mmap_obj = None   
@@ -119,22 +184,33 @@ def get_buffer_view(offset, length):
         print(f"[IPC Python] Error: Invalid buffer access - mmap_obj={mmap_obj}, offset={offset}, length={length}, mmap_size={mmap_obj.size() if mmap_obj else 'N/A'}")
         return None
 
-def process_data_from_creator(data_len):
-    """Processes data received from the Creator (C++)."""
-    print(f"[IPC Python Acceptor] Received command: Process {data_len} bytes from Creator.")
+def process_data_from_creator(slot_index, data_len):
+    """Processes data received from the Creator (C++) ring slot.
+
+    Every message starts with a 4-byte big-endian request id which must be
+    echoed back at the front of the response so the Creator can correlate
+    concurrent in-flight requests (id 0 = uncorrelated legacy message).
+    """
+    print(f"[IPC Python Acceptor] Ring slot {slot_index}: Process {data_len} bytes from Creator.")
+    request_id_prefix = b"\x00\x00\x00\x00"
     if data_len > 0:
-        # Check against the actual C2A buffer size
+        # Check against the actual C2A slot size
         if data_len > ACTUAL_C2A_BUFFER_SIZE:
              print(f"[IPC Python Acceptor] Error: data_len ({data_len}) > ACTUAL_C2A_BUFFER_SIZE ({ACTUAL_C2A_BUFFER_SIZE})")
-             return b"Error: Creator data too large"
+             return request_id_prefix + b"Error: Creator data too large"
         try:
-            # Read from C2A buffer (offset is control block size)
-            c2a_buffer_offset = SHM_CONTROL_BLOCK_SIZE
+            # Read from the C2A slot (slots are back-to-back after the control block)
+            c2a_buffer_offset = SHM_CONTROL_BLOCK_SIZE + slot_index * ACTUAL_C2A_BUFFER_SIZE
             c2a_buffer = get_buffer_view(c2a_buffer_offset, data_len)
             if c2a_buffer is None:
-                 return b"Error: Failed to get C2A buffer view"
-            input_bytes = c2a_buffer
-            
+                 return request_id_prefix + b"Error: Failed to get C2A buffer view"
+            # Split off the request id prefix, keep it for the response
+            if data_len >= REQUEST_ID_SIZE:
+                request_id_prefix = bytes(c2a_buffer[:REQUEST_ID_SIZE])
+                input_bytes = c2a_buffer[REQUEST_ID_SIZE:]
+            else:
+                input_bytes = c2a_buffer
+
             # --- Example Processing --- 
             width, height = 10, 10
             gray_image = np.zeros((height, width), dtype=np.uint8)
@@ -147,12 +223,12 @@ def process_data_from_creator(data_len):
             # -------------------------
 
             print(f"[IPC Python Acceptor] Processing complete. Response size: {len(response_data)} bytes.")
-            return response_data
+            return request_id_prefix + response_data
         except Exception as e:
             print(f"[IPC Python Acceptor] Error processing data: {e}")
             traceback.print_exc()
-            return b"Error during Python processing"
-    return b"Acknowledged empty Creator message" 
+            return request_id_prefix + b"Error during Python processing"
+    return request_id_prefix + b"Acknowledged empty Creator message"
 
 def send_data_to_creator(data_bytes):
     """Sends data back to the Creator (C++)."""
@@ -162,34 +238,37 @@ def send_data_to_creator(data_bytes):
         return False
 
     data_len = len(data_bytes)
-    
-    # Calculate offset using the actual C2A size read from SHM
-    a2c_buffer_offset = SHM_CONTROL_BLOCK_SIZE + ACTUAL_C2A_BUFFER_SIZE 
-    print(f"[IPC Python Acceptor] Calculated A2C offset: {a2c_buffer_offset}") 
 
-    # Check size against the actual A2C size read from SHM
+    # Check size against the actual A2C slot size read from SHM
     if data_len > ACTUAL_A2C_BUFFER_SIZE:
         print(f"[IPC Python Acceptor] Error: Response data size ({data_len}) exceeds ACTUAL_A2C_BUFFER_SIZE ({ACTUAL_A2C_BUFFER_SIZE}). Signaling error.")
-        while shm_struct.a_to_c_status != 0 and running: time.sleep(0.005) 
-        if not running: return False
-        shm_struct.a_to_c_data_len = 0
         shm_struct.a_to_c_status = -1
         return False
 
-    # --- Busy-wait for Creator to be ready --- 
+    # --- Wait only when ALL A2C ring slots are in flight ---
+    ring = shm_struct.a2c_ring
     wait_start_time = time.time()
-    while shm_struct.a_to_c_status != 0:
-        if not running: print("[IPC Python Acceptor] Shutdown requested while waiting to send."); return False
-        if time.time() - wait_start_time > 5.0: print("[IPC Python Acceptor] Error: Timeout waiting for Creator ack."); return False
-        time.sleep(0.005) 
-    # ---------------------------------------
+    while True:
+        doorbell_seen = ring.space_doorbell
+        if ring.head - ring.tail < SHM_RING_SLOT_COUNT:
+            break
+        if not running: print("[IPC Python Acceptor] Shutdown requested while waiting for a free slot."); return False
+        if time.time() - wait_start_time > 5.0: print("[IPC Python Acceptor] Error: Timeout waiting for a free A2C ring slot."); return False
+        doorbell_wait(ring, "space_doorbell", doorbell_seen, 0.1)
+    # -------------------------------------------------------
 
     try:
-        # Write data using mmap seek and write at the corrected offset
+        head = ring.head
+        slot_index = head % SHM_RING_SLOT_COUNT
+        # Slots for A2C start after the control block and all C2A slots
+        a2c_buffer_offset = (SHM_CONTROL_BLOCK_SIZE
+                             + SHM_RING_SLOT_COUNT * ACTUAL_C2A_BUFFER_SIZE
+                             + slot_index * ACTUAL_A2C_BUFFER_SIZE)
+
         if mmap_obj.size() < a2c_buffer_offset + data_len:
             print(f"[IPC Python Acceptor] Error: Calculated write position ({a2c_buffer_offset + data_len}) exceeds mmap size ({mmap_obj.size()}).")
             return False
-            
+
         # --- Log data hex preview BEFORE writing ---
         hex_preview_before_write = bytesToHexPreview(data_bytes)
         print(f"[IPC Python Acceptor] PRE-WRITE Hex Preview: {hex_preview_before_write}")
@@ -203,15 +282,16 @@ def send_data_to_creator(data_bytes):
 
         # Flush changes
         try:
-            mmap_obj.flush() 
+            mmap_obj.flush()
         except OSError as e:
-            print(f"[IPC Python Acceptor] Warning: mmap.flush failed: {e}") 
+            print(f"[IPC Python Acceptor] Warning: mmap.flush failed: {e}")
 
-        # Set length first, then status
-        shm_struct.a_to_c_data_len = data_len 
-        shm_struct.a_to_c_status = 1
+        # Set slot length first, then publish by advancing head
+        ring.slot_len[slot_index] = data_len
+        ring.head = head + 1
+        doorbell_ring(ring, "data_doorbell")  # Wake the C++ listener
 
-        print(f"[IPC Python Acceptor] Response ({data_len} bytes) written to A2C buffer (mmap @{a2c_buffer_offset}). Status set to 1.")
+        print(f"[IPC Python Acceptor] Response ({data_len} bytes) published in A2C ring slot {slot_index} (mmap @{a2c_buffer_offset}).")
         return True
 
     except Exception as e:
@@ -219,14 +299,7 @@ def send_data_to_creator(data_bytes):
         traceback.print_exc()
         # Attempt to signal error if possible
         try:
-            wait_start_time = time.time()
-            while shm_struct.a_to_c_status != 0:
-                 if not running: break
-                 if time.time() - wait_start_time > 0.5: break 
-                 time.sleep(0.005)
-            if running and shm_struct.a_to_c_status == 0:
-                 shm_struct.a_to_c_data_len = 0
-                 shm_struct.a_to_c_status = -1 
+            shm_struct.a_to_c_status = -1
         except Exception as e_inner:
              print(f"[IPC Python Acceptor] Error trying to signal send error: {e_inner}")
         return False
@@ -311,11 +384,17 @@ def main_loop(shm_name):
         if ACTUAL_C2A_BUFFER_SIZE <= 0 or ACTUAL_A2C_BUFFER_SIZE <= 0:
             raise ValueError("Buffer sizes read from SHM are zero or invalid.")
         print(f"[IPC Python Acceptor] Read defined buffer sizes from SHM: C2A={ACTUAL_C2A_BUFFER_SIZE}, A2C={ACTUAL_A2C_BUFFER_SIZE}")
-        expected_total = SHM_CONTROL_BLOCK_SIZE + ACTUAL_C2A_BUFFER_SIZE + ACTUAL_A2C_BUFFER_SIZE
-        print(f"          (Control Size: {SHM_CONTROL_BLOCK_SIZE})")
+        # Slot sizes are chosen by the Creator at runtime; the full layout is
+        # control block + SLOT_COUNT buffers per direction (the mapping itself
+        # may be larger - it is rounded up for hugepage backing).
+        expected_total = (SHM_CONTROL_BLOCK_SIZE
+                          + SHM_RING_SLOT_COUNT * (ACTUAL_C2A_BUFFER_SIZE + ACTUAL_A2C_BUFFER_SIZE))
+        print(f"          (Control Size: {SHM_CONTROL_BLOCK_SIZE}, Expected Layout: {expected_total})")
         if expected_total > mmap_obj.size():
-             print(f"[IPC Python Acceptor] Warning: Sum of control block and defined buffer sizes ({expected_total}) exceeds mapped size ({mmap_obj.size()}).")
-             # Decide whether to proceed or exit
+             print(f"[IPC Python Acceptor] Error: Required layout ({expected_total}) exceeds mapped size ({mmap_obj.size()}). Exiting.")
+             mmap_obj.close()
+             if c_close and shm_fd != -1: c_close(shm_fd)
+             sys.exit(1)
     except AttributeError:
          print("[IPC Python Acceptor] Error: Failed to read defined buffer sizes from SHM struct. Structure mismatch?")
          if mmap_obj: mmap_obj.close()
@@ -328,44 +407,53 @@ def main_loop(shm_name):
          sys.exit(1)
     # -------------------------------------------
         
-    # --- Set up signal handlers --- 
+    # --- Set up signal handlers ---
     signal.signal(signal.SIGINT, signal_handler)
     signal.signal(signal.SIGTERM, signal_handler)
 
+    # --- Signal readiness to the Creator ---
+    # Everything the Creator's wait_for_acceptor_ready() cares about is done:
+    # segment mapped, layout validated. Plain int store; the Creator reads it
+    # with acquire semantics so the checks above are visible first.
+    shm_struct.acceptor_ready = 1
+
     print("[IPC Python Acceptor] Initialization complete. Polling for Creator commands...")
 
-    # --- Main Polling Loop --- 
+    # --- Main Polling Loop ---
     try:
         while running:
             try:
-                # Check command from Creator
+                # Check command from Creator (shutdown only; data rides the ring)
                 command = shm_struct.c_to_a_command # Use c_to_a
 
-                if command == 1: # Data Ready from Creator
-                    data_len = shm_struct.c_to_a_data_len # Use c_to_a
-                    response_bytes = process_data_from_creator(data_len) # Call renamed func
-                    
+                if command == 99: # Shutdown command from Creator
+                    print("[IPC Python Acceptor] Received shutdown command (99). Acknowledging and exiting.")
+                    shm_struct.c_to_a_command = 0 # Acknowledge
+                    running = False
+                    break
+
+                # --- Drain the C2A ring ---
+                ring = shm_struct.c2a_ring
+                doorbell_seen = ring.data_doorbell
+                if ring.head == ring.tail: # Ring empty - block until the Creator rings
+                    doorbell_wait(ring, "data_doorbell", doorbell_seen, 0.1)
+                    continue
+
+                while ring.tail != ring.head and running:
+                    tail = ring.tail
+                    slot_index = tail % SHM_RING_SLOT_COUNT
+                    data_len = ring.slot_len[slot_index]
+                    response_bytes = process_data_from_creator(slot_index, data_len)
+
                     if response_bytes is not None:
                         send_data_to_creator(response_bytes) # Call renamed func
                     else:
-                         send_data_to_creator(b"Error during Creator data processing in Acceptor") 
-                    
-                    # Acknowledge Creator command 
-                    shm_struct.c_to_a_command = 0 
-                    print("[IPC Python Acceptor] Acknowledged Creator command (set c_to_a_command = 0). Waiting...")
+                         send_data_to_creator(b"\x00\x00\x00\x00" + b"Error during Creator data processing in Acceptor")
 
-                elif command == 99: # Shutdown command from Creator
-                    print("[IPC Python Acceptor] Received shutdown command (99). Acknowledging and exiting.")
-                    shm_struct.c_to_a_command = 0 # Acknowledge
-                    running = False
-                    break 
-
-                elif command == 0: # Idle
-                    time.sleep(0.005) 
-                else:
-                    print(f"[IPC Python Acceptor] Warning: Unknown command {command} received from Creator. Resetting.")
-                    shm_struct.c_to_a_command = 0 
-                    time.sleep(0.01) 
+                    # Release the slot back to the Creator and wake it if it
+                    # is blocked waiting for ring space
+                    ring.tail = tail + 1
+                    doorbell_ring(ring, "space_doorbell")
 
             except Exception as e:
                  print(f"[IPC Python Acceptor] Error in main loop: {e}")
@@ -1,4 +1,6 @@
 #include "python_ipc.h"
+#include "BPG_Protocol/bpg_logging.h"
+#include "BPG_Protocol/bpg_latency.h" // Python round-trip latency stage
 #include <iostream>
 #include <string>
 #include <vector>
@@ -16,20 +18,47 @@
 #include <sys/stat.h>    // For mode constants
 #include <unistd.h>      // For ftruncate, close
 #include <signal.h>      // For kill
+#include <spawn.h>       // For posix_spawnp (direct fork+exec, no shell)
+#include <sys/wait.h>    // For waitpid
 #include <cstdlib>       // For system(), WEXITSTATUS, WIFEXITED etc.
 #include <cstring>       // For memcpy, memset
 #include <cerrno>        // For errno
+#include <arpa/inet.h>   // For htonl, ntohl (request id stamping)
+
+#if defined(__linux__)
+#include <linux/futex.h> // For FUTEX_WAIT / FUTEX_WAKE
+#include <sys/syscall.h> // For SYS_futex
+#include <climits>       // For INT_MAX
+#define SHM_IPC_HAVE_FUTEX 1
+#endif
 
 // Global variables for Bi-directional IPC
 static int shm_fd_bi = -1;
 static SharedIPCBidirectional* shm_ptr_bi = nullptr;
+static size_t shm_mapped_size = 0;
 static std::thread listener_thread;    // Thread to listen for Acceptor messages
 static std::atomic<bool> keep_listener_running(false);
 static AcceptorDataCallback data_callback = nullptr; // Use renamed callback type
-static std::mutex send_mutex; 
+static std::mutex send_mutex;
+static pid_t acceptor_pid = -1;        // Spawned Acceptor process (reaped at shutdown)
+
+extern char **environ; // For posix_spawnp
+
+// --- Pending request table (lock-free) ---
+// A slot is free while request_id == 0. Senders claim a slot with a CAS,
+// fill in their context, then enqueue; the listener looks the echoed id up
+// and releases the slot. No mutex is ever taken on the receive path.
+struct PendingRequest {
+    std::atomic<uint32_t> request_id{0}; // 0 = slot free
+    uint32_t group_id = 0;
+    uint32_t target_id = 0;
+    uint64_t send_time_ns = 0; // Round-trip latency stage start
+};
+static PendingRequest pending_requests[IPC_MAX_PENDING_REQUESTS];
+static std::atomic<uint32_t> next_request_id(1);
 
 // --- Helper function for Hex Preview ---
-std::string bytes_to_hex_preview_cpp(const uint8_t* data, size_t length, size_t max_bytes = 30) {
+[[maybe_unused]] static std::string bytes_to_hex_preview_cpp(const uint8_t* data, size_t length, size_t max_bytes = 30) {
     if (!data || length == 0) {
         return "(no binary data)";
     }
@@ -53,63 +82,132 @@ std::string bytes_to_hex_preview_cpp(const uint8_t* data, size_t length, size_t
     return ss.str();
 }
 
-// --- Listener Thread Function (Busy-Wait Version) ---
+// --- Cross-process wakeup primitives (futex on Linux, polling elsewhere) ---
+// Waiters sample the doorbell word, re-check the ring condition, and only
+// then block on the sampled value - a concurrent publish makes the word
+// differ and the wait returns immediately. Waits are bounded so shutdown and
+// shared-memory teardown can never hang on a dead peer.
+
+#if defined(SHM_IPC_HAVE_FUTEX)
+static void shm_doorbell_wait(std::atomic<uint32_t>& doorbell, uint32_t seen_value, long timeout_us) {
+    struct timespec ts;
+    ts.tv_sec = timeout_us / 1000000;
+    ts.tv_nsec = (timeout_us % 1000000) * 1000;
+    // NOTE: no FUTEX_PRIVATE_FLAG - the word is shared with the Python process.
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(&doorbell), FUTEX_WAIT, seen_value, &ts, nullptr, 0);
+}
+
+static void shm_doorbell_ring(std::atomic<uint32_t>& doorbell) {
+    doorbell.fetch_add(1, std::memory_order_release);
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(&doorbell), FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+}
+#else
+static void shm_doorbell_wait(std::atomic<uint32_t>& doorbell, uint32_t seen_value, long timeout_us) {
+    (void)doorbell; (void)seen_value;
+    std::this_thread::sleep_for(std::chrono::microseconds(std::min(timeout_us, 500L)));
+}
+
+static void shm_doorbell_ring(std::atomic<uint32_t>& doorbell) {
+    doorbell.fetch_add(1, std::memory_order_release);
+}
+#endif
+
+// --- Listener Thread Function (Ring-Drain Version) ---
 void acceptor_listener_thread_func() { // Renamed function
-    std::cout << "[IPC C++ Listener] Listener thread for Acceptor started (polling mode)." << std::endl;
+    BPG_LOGI("[IPC C++ Listener] Listener thread for Acceptor started (ring mode).");
     while (keep_listener_running.load()) {
-        if (!shm_ptr_bi) { 
-            std::cerr << "[IPC C++ Listener] Error: Shared memory pointer is null. Exiting thread." << std::endl;
+        if (!shm_ptr_bi) {
+            BPG_LOGE("[IPC C++ Listener] Error: Shared memory pointer is null. Exiting thread.");
             keep_listener_running.store(false);
             break;
         }
 
-        // --- Poll status from Acceptor --- 
-        int32_t a_status = shm_ptr_bi->a_to_c_status.load(); // Use a_to_c_status
+        // --- Check error flag from Acceptor ---
+        if (shm_ptr_bi->a_to_c_status.load() == -1) {
+            BPG_LOGE("[IPC C++ Listener] Received Error Status (-1) from Acceptor.");
+            shm_ptr_bi->a_to_c_status.store(0);
+        }
+
+        // --- Drain the A->C ring ---
+        ShmMsgRing& ring = shm_ptr_bi->a2c_ring;
+        uint64_t tail = ring.tail.load(std::memory_order_relaxed);
+        uint32_t doorbell_seen = ring.data_doorbell.load(std::memory_order_acquire);
+        uint64_t head = ring.head.load(std::memory_order_acquire);
+
+        if (head == tail) { // Ring empty - block until the Acceptor rings
+            shm_doorbell_wait(ring.data_doorbell, doorbell_seen, 100000 /* 100ms safety bound */);
+            continue;
+        }
 
-        if (a_status == 1) { // Data Ready from Acceptor
-            size_t data_len = shm_ptr_bi->a_to_c_data_len.load(); // Use a_to_c_data_len
-            std::cout << "[IPC C++ Listener] Received Status=1 from Acceptor, Data Len=" << data_len << std::endl; 
-            std::this_thread::sleep_for(std::chrono::microseconds(500)); // Keep delay for now
+        while (tail != head && keep_listener_running.load()) {
+            size_t slot = static_cast<size_t>(tail % SHM_RING_SLOT_COUNT);
+            size_t data_len = static_cast<size_t>(ring.slot_len[slot].load(std::memory_order_relaxed));
+            BPG_LOGT("[IPC C++ Listener] Ring slot " << slot << " ready from Acceptor, Data Len=" << data_len);
+
+            // Check received length against the defined A->C (RX) slot size
+            if (data_len <= shm_ptr_bi->defined_a2c_buffer_size && data_len > 0) {
+                const uint8_t* acceptor_buffer_ptr =
+                    reinterpret_cast<const uint8_t*>(shm_a2c_slot(shm_ptr_bi, slot));
+                // TRACE-only: the per-message hex preview stringstream was a
+                // fixed formatting cost on every response
+#if BPG_LOG_COMPILE_LEVEL >= 4
+                BPG_LOGT("[IPC C++ Listener] Acceptor SHM Slot Preview: "
+                         << bytes_to_hex_preview_cpp(acceptor_buffer_ptr, data_len));
+#endif
+
+                // --- Correlate the echoed request id back to its context ---
+                uint32_t resp_group_id = 0;
+                uint32_t resp_target_id = 0;
+                const uint8_t* payload_ptr = acceptor_buffer_ptr;
+                size_t payload_len = data_len;
+                if (data_len >= IPC_REQUEST_ID_SIZE) {
+                    uint32_t req_id_n;
+                    memcpy(&req_id_n, acceptor_buffer_ptr, IPC_REQUEST_ID_SIZE);
+                    uint32_t req_id = ntohl(req_id_n);
+                    payload_ptr += IPC_REQUEST_ID_SIZE;
+                    payload_len -= IPC_REQUEST_ID_SIZE;
+                    if (req_id != 0) {
+                        bool found = false;
+                        for (size_t i = 0; i < IPC_MAX_PENDING_REQUESTS; ++i) {
+                            if (pending_requests[i].request_id.load(std::memory_order_acquire) == req_id) {
+                                resp_group_id = pending_requests[i].group_id;
+                                resp_target_id = pending_requests[i].target_id;
+                                BPG::LatencyStats::instance().record(
+                                    BPG::LatencyStage::kPythonRoundTrip,
+                                    BPG::latencyNowNs() - pending_requests[i].send_time_ns);
+                                pending_requests[i].request_id.store(0, std::memory_order_release);
+                                found = true;
+                                break;
+                            }
+                        }
+                        if (!found) {
+                            BPG_LOGW("[IPC C++ Listener] Warning: Response for unknown request id " << req_id << " (timed out or duplicate?).");
+                        }
+                    }
+                }
 
-            // Check received length against the defined A->C (RX) buffer size
-            if (data_len <= shm_ptr_bi->defined_a2c_buffer_size && data_len > 0) { // Use defined_a2c_buffer_size
-                const uint8_t* acceptor_buffer_ptr = reinterpret_cast<const uint8_t*>(shm_ptr_bi->buffer_a_to_c); // Use buffer_a_to_c
-                std::string hex_preview = bytes_to_hex_preview_cpp(acceptor_buffer_ptr, data_len);
-                std::cout << "[IPC C++ Listener] Acceptor SHM Buffer Preview (after delay): " << hex_preview << std::endl;
                 if (data_callback) {
                     try {
-                        data_callback(acceptor_buffer_ptr, data_len); 
+                        data_callback(resp_group_id, resp_target_id, payload_ptr, payload_len);
                     } catch (const std::exception& e) {
-                        std::cerr << "[IPC C++ Listener] Exception in data_callback: " << e.what() << std::endl;
+                        BPG_LOGE("[IPC C++ Listener] Exception in data_callback: " << e.what());
                     } catch (...) {
-                        std::cerr << "[IPC C++ Listener] Unknown exception in data_callback." << std::endl;
+                        BPG_LOGE("[IPC C++ Listener] Unknown exception in data_callback.");
                     }
                 } else {
-                    std::cerr << "[IPC C++ Listener] Warning: No data callback registered." << std::endl;
+                    BPG_LOGW("[IPC C++ Listener] Warning: No data callback registered.");
                 }
             } else {
-                 std::cerr << "[IPC C++ Listener] Error: Acceptor reported data size (" << data_len
-                           << ") invalid or larger than defined A->C buffer (" 
-                           << shm_ptr_bi->defined_a2c_buffer_size << ")." << std::endl; // Use defined_a2c_buffer_size
+                 BPG_LOGE("[IPC C++ Listener] Error: Acceptor reported data size (" << data_len << ") invalid or larger than defined A->C slot (" << shm_ptr_bi->defined_a2c_buffer_size << ").");
             }
-            // Acknowledge processing by resetting Acceptor's status
-            shm_ptr_bi->a_to_c_status.store(0); // Use a_to_c_status
-            std::cout << "[IPC C++ Listener] Acknowledged Acceptor (set a_to_c_status = 0)." << std::endl;
-
-        } else if (a_status == -1) { // Error status from Acceptor
-            std::cerr << "[IPC C++ Listener] Received Error Status (-1) from Acceptor." << std::endl;
-            shm_ptr_bi->a_to_c_status.store(0); // Use a_to_c_status
-             std::cout << "[IPC C++ Listener] Acknowledged Acceptor Error (set a_to_c_status = 0)." << std::endl;
-
-        } else if (a_status == 0) { // Idle status from Acceptor
-            std::this_thread::sleep_for(std::chrono::microseconds(500)); 
-        } else { // Unknown status
-             std::cerr << "[IPC C++ Listener] Warning: Unknown Acceptor status code: " << a_status << ". Resetting." << std::endl;
-             shm_ptr_bi->a_to_c_status.store(0); // Use a_to_c_status
-             std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            // Release the slot back to the Acceptor and wake it if it is
+            // blocked waiting for ring space
+            ++tail;
+            ring.tail.store(tail, std::memory_order_release);
+            shm_doorbell_ring(ring.space_doorbell);
         }
     }
-    std::cout << "[IPC C++ Listener] Listener thread exiting." << std::endl;
+    BPG_LOGI("[IPC C++ Listener] Listener thread exiting.");
 }
 
 // --- Implementation of Public Functions --- 
@@ -117,19 +215,31 @@ void acceptor_listener_thread_func() { // Renamed function
 bool init_acceptor_ipc_bidirectional( // Renamed function
     const std::string& acceptor_executable,
     const std::string& acceptor_script_path,
-    AcceptorDataCallback callback)
+    AcceptorDataCallback callback,
+    size_t c2a_slot_size,
+    size_t a2c_slot_size)
 {
-    std::cout << "[IPC C++] Initializing Bi-directional IPC with Acceptor..." << std::endl;
-    data_callback = callback; 
+    BPG_LOGI("[IPC C++] Initializing Bi-directional IPC with Acceptor...");
+    data_callback = callback;
     shm_unlink(SHM_NAME_BI);
 
-    // --- Create/Open Shared Memory --- 
-    size_t control_block_size = 128; 
-    size_t total_shm_size = control_block_size + SHM_C2A_BUFFER_MAX_SIZE + SHM_A2C_BUFFER_MAX_SIZE; // Use renamed constants 
-    std::cout << "[IPC C++] Calculated total SHM allocation size: " << total_shm_size << " bytes." << std::endl;
-    std::cout << "          Control Block Size: " << control_block_size << std::endl;
-    std::cout << "          Max C2A Size: " << SHM_C2A_BUFFER_MAX_SIZE << std::endl; // Use renamed constants 
-    std::cout << "          Max A2C Size: " << SHM_A2C_BUFFER_MAX_SIZE << std::endl; // Use renamed constants 
+    if (c2a_slot_size == 0 || a2c_slot_size == 0) {
+        BPG_LOGE("[IPC C++] Error: Slot sizes must be non-zero.");
+        return false;
+    }
+
+    // --- Create/Open Shared Memory ---
+    // Control block + runtime-sized slots; rounded up to a 2MB boundary so
+    // the segment can be backed by huge pages.
+    const size_t kHugePageSize = 2 * 1024 * 1024;
+    size_t total_shm_size = sizeof(SharedIPCBidirectional)
+                          + SHM_RING_SLOT_COUNT * c2a_slot_size
+                          + SHM_RING_SLOT_COUNT * a2c_slot_size;
+    total_shm_size = (total_shm_size + kHugePageSize - 1) & ~(kHugePageSize - 1);
+    BPG_LOGI("[IPC C++] Calculated total SHM allocation size: " << total_shm_size << " bytes.");
+    BPG_LOGI("          Ring Slots per Direction: " << SHM_RING_SLOT_COUNT);
+    BPG_LOGI("          C2A Slot Size: " << c2a_slot_size);
+    BPG_LOGI("          A2C Slot Size: " << a2c_slot_size);
 
     shm_fd_bi = shm_open(SHM_NAME_BI, O_CREAT | O_RDWR, 0666);
     if (shm_fd_bi == -1) {
@@ -145,134 +255,246 @@ bool init_acceptor_ipc_bidirectional( // Renamed function
         perror("[IPC C++] mmap failed");
         close(shm_fd_bi); shm_unlink(SHM_NAME_BI); return false;
     }
-    std::cout << "[IPC C++] Bi-directional SHM created/opened and mapped." << std::endl;
-    std::this_thread::sleep_for(std::chrono::milliseconds(50)); // Keep delay for safety
+    shm_mapped_size = total_shm_size;
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+    // Best effort: ask for transparent huge pages so the 30fps multi-MB
+    // transfers stop thrashing the TLB. /dev/shm (tmpfs) honors this when
+    // shmem THP is enabled; otherwise the kernel just ignores the hint.
+    // (MAP_HUGETLB is not usable here - it requires a hugetlbfs fd, not one
+    // from shm_open - so the madvise route is the portable option.)
+    if (madvise(shm_ptr_bi, total_shm_size, MADV_HUGEPAGE) != 0) {
+        BPG_LOGD("[IPC C++] madvise(MADV_HUGEPAGE) not honored (" << strerror(errno)
+                 << "), continuing with base pages.");
+    } else {
+        BPG_LOGI("[IPC C++] Requested huge page backing for the SHM segment.");
+    }
+#endif
+    BPG_LOGI("[IPC C++] Bi-directional SHM created/opened and mapped.");
 
-    // --- Initialize Shared Memory Control Block --- 
+    // --- Initialize Shared Memory Control Block ---
     new (&shm_ptr_bi->c_to_a_command) std::atomic<int32_t>(0); // Use c_to_a
-    new (&shm_ptr_bi->c_to_a_data_len) std::atomic<size_t>(0); // Use c_to_a
     new (&shm_ptr_bi->a_to_c_status) std::atomic<int32_t>(0);  // Use a_to_c
-    new (&shm_ptr_bi->a_to_c_data_len) std::atomic<size_t>(0);  // Use a_to_c
-    
-    // Set the defined buffer sizes using the specific constants
-    shm_ptr_bi->defined_c2a_buffer_size = SHM_C2A_BUFFER_MAX_SIZE; // Use renamed constants & fields
-    shm_ptr_bi->defined_a2c_buffer_size = SHM_A2C_BUFFER_MAX_SIZE; // Use renamed constants & fields
-    std::cout << "[IPC C++] Set defined buffer sizes in SHM: C2A=" 
-              << shm_ptr_bi->defined_c2a_buffer_size << ", A2C=" 
-              << shm_ptr_bi->defined_a2c_buffer_size << std::endl;
-
-    // Zero out padding and buffers using their specific max sizes
+    new (&shm_ptr_bi->acceptor_ready) std::atomic<int32_t>(0); // Acceptor sets 1 when mapped
+    shm_ptr_bi->_reserved0 = 0;
+    for (ShmMsgRing* ring : { &shm_ptr_bi->c2a_ring, &shm_ptr_bi->a2c_ring }) {
+        new (&ring->head) std::atomic<uint64_t>(0);
+        new (&ring->tail) std::atomic<uint64_t>(0);
+        for (size_t i = 0; i < SHM_RING_SLOT_COUNT; ++i) {
+            new (&ring->slot_len[i]) std::atomic<uint64_t>(0);
+        }
+        new (&ring->data_doorbell) std::atomic<uint32_t>(0);
+        new (&ring->space_doorbell) std::atomic<uint32_t>(0);
+    }
+
+    // Set the defined per-slot buffer sizes using the specific constants
+    shm_ptr_bi->defined_c2a_buffer_size = c2a_slot_size;
+    shm_ptr_bi->defined_a2c_buffer_size = a2c_slot_size;
+    shm_ptr_bi->ring_slot_count = SHM_RING_SLOT_COUNT;
+    BPG_LOGI("[IPC C++] Set defined slot sizes in SHM: C2A=" << shm_ptr_bi->defined_c2a_buffer_size << ", A2C=" << shm_ptr_bi->defined_a2c_buffer_size << ", Slots=" << shm_ptr_bi->ring_slot_count);
+
+    // Zero out padding and slot buffers
     memset(shm_ptr_bi->_padding1, 0, sizeof(shm_ptr_bi->_padding1));
-    memset(shm_ptr_bi->buffer_c_to_a, 0, SHM_C2A_BUFFER_MAX_SIZE); // Use renamed buffer & constant
-    memset(shm_ptr_bi->buffer_a_to_c, 0, SHM_A2C_BUFFER_MAX_SIZE); // Use renamed buffer & constant
-    std::cout << "[IPC C++] Bi-directional SHM control block initialized." << std::endl;
+    memset(shm_c2a_slot(shm_ptr_bi, 0), 0, shm_mapped_size - sizeof(SharedIPCBidirectional));
+    BPG_LOGI("[IPC C++] Bi-directional SHM control block initialized.");
 
-    // --- Launch Acceptor Script --- 
+    // --- Launch Acceptor Script ---
+    // posix_spawnp instead of system(): no intermediate shell fork, a real
+    // pid to reap at shutdown, and a definitive error when the executable
+    // cannot even be started. Readiness is NOT waited for here - the
+    // Acceptor flips acceptor_ready in the control block once it has
+    // mapped and validated the segment; callers that need the channel up
+    // use wait_for_acceptor_ready() instead of a blind sleep.
     std::string full_script_path = "APP/backend/" + acceptor_script_path; // Construct path relative to project root
-    std::string command = acceptor_executable + " -u " + full_script_path + " " 
-                         + SHM_NAME_BI + " &"; 
-    std::cout << "[IPC C++] Launching Acceptor script: " << command << std::endl;
-    int result = system(command.c_str());
-     if (result != 0) {
-        // Note: system() return value is complex to interpret reliably for background processes.
-        // We might not get a useful error code here if the script fails later.
-        std::cerr << "[IPC C++] Warning: system() call for Acceptor script returned non-zero or error. Check script output/logs." << std::endl;
-        // Consider adding a short delay and then checking if Acceptor is alive, 
-        // or having Acceptor create a small pid/status file on successful startup.
+    const char* spawn_argv[] = {
+        acceptor_executable.c_str(), "-u", full_script_path.c_str(), SHM_NAME_BI, nullptr
+    };
+    BPG_LOGI("[IPC C++] Spawning Acceptor: " << acceptor_executable << " -u "
+             << full_script_path << " " << SHM_NAME_BI);
+    pid_t spawned_pid = -1;
+    int spawn_rc = posix_spawnp(&spawned_pid, acceptor_executable.c_str(),
+                                nullptr, nullptr,
+                                const_cast<char* const*>(spawn_argv), environ);
+    if (spawn_rc != 0) {
+        BPG_LOGE("[IPC C++] Error: posix_spawnp failed for Acceptor: " << strerror(spawn_rc));
+        munmap(shm_ptr_bi, shm_mapped_size);
+        shm_ptr_bi = nullptr;
+        close(shm_fd_bi); shm_unlink(SHM_NAME_BI);
+        return false;
     }
+    acceptor_pid = spawned_pid;
 
     // --- Start Listener Thread --- 
     keep_listener_running.store(true);
     listener_thread = std::thread(acceptor_listener_thread_func); // Call renamed listener
-    std::cout << "[IPC C++] Listener thread starting." << std::endl;
+    BPG_LOGI("[IPC C++] Listener thread starting.");
 
-    std::cout << "[IPC C++] Bi-directional IPC Initialization complete." << std::endl;
+    BPG_LOGI("[IPC C++] Bi-directional IPC Initialization complete.");
     return true;
 }
 
 void shutdown_acceptor_ipc_bidirectional() { // Renamed function
-    std::cout << "[IPC C++] Shutting down Bi-directional IPC with Acceptor..." << std::endl;
+    BPG_LOGI("[IPC C++] Shutting down Bi-directional IPC with Acceptor...");
 
     // --- Stop Listener Thread --- 
     if (keep_listener_running.load()) {
         keep_listener_running.store(false);
         if (listener_thread.joinable()) {
             listener_thread.join();
-             std::cout << "[IPC C++] Listener thread joined." << std::endl;
+             BPG_LOGI("[IPC C++] Listener thread joined.");
         }
     }
 
     // --- Signal Acceptor process to shut down via SHM flag --- 
     if (shm_ptr_bi) {
-        std::cout << "[IPC C++] Sending Shutdown command (99) to Acceptor..." << std::endl;
+        BPG_LOGI("[IPC C++] Sending Shutdown command (99) to Acceptor...");
         shm_ptr_bi->c_to_a_command.store(99); // Use c_to_a_command
+        // Ring the data doorbell so a blocked Acceptor notices the command
+        shm_doorbell_ring(shm_ptr_bi->c2a_ring.data_doorbell);
 
         // Optional: Wait briefly for Acceptor to acknowledge shutdown
         auto shutdown_start = std::chrono::steady_clock::now();
         while (shm_ptr_bi->c_to_a_command.load() == 99) { // Use c_to_a_command
             if (std::chrono::steady_clock::now() - shutdown_start > std::chrono::milliseconds(500)) {
-                 std::cerr << "[IPC C++] Warning: Timeout waiting for Acceptor to acknowledge shutdown command." << std::endl;
+                 BPG_LOGW("[IPC C++] Warning: Timeout waiting for Acceptor to acknowledge shutdown command.");
                  break;
             }
              std::this_thread::sleep_for(std::chrono::milliseconds(50));
         }
         if (shm_ptr_bi->c_to_a_command.load() == 0) { // Use c_to_a_command
-             std::cout << "[IPC C++] Acceptor acknowledged shutdown command." << std::endl;
+             BPG_LOGI("[IPC C++] Acceptor acknowledged shutdown command.");
         }
 
-        // Calculate total size for munmap using the MAX constants
-        size_t control_block_size = 128;
-        size_t total_shm_size = control_block_size + SHM_C2A_BUFFER_MAX_SIZE + SHM_A2C_BUFFER_MAX_SIZE;
-        munmap(shm_ptr_bi, total_shm_size);
+        munmap(shm_ptr_bi, shm_mapped_size);
         shm_ptr_bi = nullptr;
-         std::cout << "[IPC C++] Shared memory unmapped." << std::endl;
+        shm_mapped_size = 0;
+         BPG_LOGI("[IPC C++] Shared memory unmapped.");
     }
 
     // --- Cleanup Resources (SHM only) --- 
     if (shm_fd_bi != -1) {
         close(shm_fd_bi); shm_fd_bi = -1;
         shm_unlink(SHM_NAME_BI);
-         std::cout << "[IPC C++] Shared memory unlinked." << std::endl;
+         BPG_LOGI("[IPC C++] Shared memory unlinked.");
+    }
+
+    // --- Reap the Acceptor process ---
+    if (acceptor_pid > 0) {
+        int status = 0;
+        auto reap_start = std::chrono::steady_clock::now();
+        while (waitpid(acceptor_pid, &status, WNOHANG) == 0) {
+            if (std::chrono::steady_clock::now() - reap_start > std::chrono::milliseconds(500)) {
+                BPG_LOGW("[IPC C++] Warning: Acceptor (pid " << acceptor_pid
+                         << ") did not exit after shutdown ack; sending SIGTERM.");
+                kill(acceptor_pid, SIGTERM);
+                waitpid(acceptor_pid, &status, 0);
+                break;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        acceptor_pid = -1;
+        BPG_LOGI("[IPC C++] Acceptor process reaped.");
     }
 
     data_callback = nullptr; // Clear callback
-    std::cout << "[IPC C++] Bi-directional IPC Shutdown complete." << std::endl;
+    BPG_LOGI("[IPC C++] Bi-directional IPC Shutdown complete.");
 }
 
-bool send_data_to_acceptor_async(const uint8_t* input_data, size_t input_len) { // Renamed function
+bool wait_for_acceptor_ready(int timeout_ms) {
+    if (!shm_ptr_bi) return false;
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+    while (shm_ptr_bi->acceptor_ready.load(std::memory_order_acquire) == 0) {
+        if (!keep_listener_running.load()) return false;
+        if (std::chrono::steady_clock::now() >= deadline) {
+            BPG_LOGW("[IPC C++] Warning: Acceptor not ready after " << timeout_ms << "ms.");
+            return false;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return true;
+}
+
+// Internal: stamps 'request_id' (0 = uncorrelated) ahead of the payload and
+// enqueues the message into the next free C->A ring slot.
+static bool send_to_acceptor_with_id(uint32_t request_id, const uint8_t* input_data, size_t input_len) {
      std::lock_guard<std::mutex> lock(send_mutex);
      if (!shm_ptr_bi) { return false; }
-     
-     // Check input length against the defined C->A (TX) buffer size
-     if (input_len > shm_ptr_bi->defined_c2a_buffer_size) { // Use defined_c2a_buffer_size
-         std::cerr << "[IPC C++] Error: Input data size (" << input_len
-                   << ") exceeds defined C->A buffer size (" << shm_ptr_bi->defined_c2a_buffer_size << ")." << std::endl;
+
+     // Check input length (plus the request id prefix) against the defined C->A (TX) slot size
+     if (input_len + IPC_REQUEST_ID_SIZE > shm_ptr_bi->defined_c2a_buffer_size) { // Use defined_c2a_buffer_size
+         BPG_LOGE("[IPC C++] Error: Input data size (" << input_len << " + " << IPC_REQUEST_ID_SIZE << " id bytes) exceeds defined C->A slot size (" << shm_ptr_bi->defined_c2a_buffer_size << ").");
         return false;
      }
 
-     // --- Busy-wait for Acceptor to be ready --- 
+     ShmMsgRing& ring = shm_ptr_bi->c2a_ring;
+     uint64_t head = ring.head.load(std::memory_order_relaxed);
+
+     // --- Wait only when ALL slots are in flight (blocking, not polling) ---
      auto wait_start_time = std::chrono::steady_clock::now();
-     while (shm_ptr_bi->c_to_a_command.load() != 0) { // Use c_to_a_command
-         if (!keep_listener_running.load()) { 
-             std::cerr << "[IPC C++] Aborting send: Shutdown in progress." << std::endl;
+     for (;;) {
+         uint32_t doorbell_seen = ring.space_doorbell.load(std::memory_order_acquire);
+         if (head - ring.tail.load(std::memory_order_acquire) < SHM_RING_SLOT_COUNT) {
+             break;
+         }
+         if (!keep_listener_running.load()) {
+             BPG_LOGE("[IPC C++] Aborting send: Shutdown in progress.");
              return false;
          }
-         if (std::chrono::steady_clock::now() - wait_start_time > std::chrono::seconds(5)) { 
-             std::cerr << "[IPC C++] Error: Timeout waiting for Acceptor to acknowledge previous C->A command (" 
-                       << shm_ptr_bi->c_to_a_command.load() << "). Sending failed." << std::endl;
-             return false; 
+         if (std::chrono::steady_clock::now() - wait_start_time > std::chrono::seconds(5)) {
+             BPG_LOGE("[IPC C++] Error: Timeout waiting for a free C->A ring slot (head=" << head << ", tail=" << ring.tail.load() << "). Sending failed.");
+             return false;
          }
-         std::this_thread::sleep_for(std::chrono::microseconds(500)); 
+         shm_doorbell_wait(ring.space_doorbell, doorbell_seen, 100000 /* 100ms safety bound */);
      }
      // ---------------------------------------
 
-     // Write data to C->A buffer
-     memcpy(shm_ptr_bi->buffer_c_to_a, input_data, input_len); // Use buffer_c_to_a
-     shm_ptr_bi->c_to_a_data_len.store(input_len); // Use c_to_a_data_len
-     shm_ptr_bi->c_to_a_command.store(1); // Use c_to_a_command
-     std::cout << "[IPC C++] Data written to C->A SHM (" << input_len << " bytes). Command set to 1." << std::endl;
+     // Write the request id prefix + data into the claimed slot, then publish it
+     size_t slot = static_cast<size_t>(head % SHM_RING_SLOT_COUNT);
+     char* slot_ptr = shm_c2a_slot(shm_ptr_bi, slot);
+     uint32_t req_id_be = htonl(request_id);
+     memcpy(slot_ptr, &req_id_be, IPC_REQUEST_ID_SIZE);
+     memcpy(slot_ptr + IPC_REQUEST_ID_SIZE, input_data, input_len);
+     ring.slot_len[slot].store(input_len + IPC_REQUEST_ID_SIZE, std::memory_order_relaxed);
+     ring.head.store(head + 1, std::memory_order_release);
+     shm_doorbell_ring(ring.data_doorbell); // Wake the Acceptor if it is blocked
+     BPG_LOGT("[IPC C++] Data written to C->A ring slot " << slot << " (req " << request_id << ", " << input_len << " bytes).");
      return true;
 }
 
+bool send_data_to_acceptor_async(const uint8_t* input_data, size_t input_len) { // Renamed function
+    // Request id 0 = uncorrelated; the response comes back with group/target 0/0.
+    return send_to_acceptor_with_id(0, input_data, input_len);
+}
+
+bool send_request_to_acceptor_async(uint32_t group_id, uint32_t target_id,
+                                    const uint8_t* input_data, size_t input_len) {
+    // Claim a pending-table slot (CAS from 0) with a fresh non-zero request id.
+    uint32_t req_id = next_request_id.fetch_add(1, std::memory_order_relaxed);
+    if (req_id == 0) req_id = next_request_id.fetch_add(1, std::memory_order_relaxed); // Skip reserved 0 on wrap
+    size_t slot_index = IPC_MAX_PENDING_REQUESTS;
+    for (size_t i = 0; i < IPC_MAX_PENDING_REQUESTS; ++i) {
+        uint32_t expected = 0;
+        if (pending_requests[i].request_id.compare_exchange_strong(
+                expected, req_id, std::memory_order_acq_rel, std::memory_order_relaxed)) {
+            // group/target are written before the message is enqueued; the listener
+            // only reads them after acquiring a matching request_id.
+            pending_requests[i].group_id = group_id;
+            pending_requests[i].target_id = target_id;
+            pending_requests[i].send_time_ns = BPG::latencyNowNs();
+            slot_index = i;
+            break;
+        }
+    }
+    if (slot_index == IPC_MAX_PENDING_REQUESTS) {
+        BPG_LOGE("[IPC C++] Error: Pending request table full (" << IPC_MAX_PENDING_REQUESTS << " responses outstanding). Sending failed.");
+        return false;
+    }
+
+    if (!send_to_acceptor_with_id(req_id, input_data, input_len)) {
+        pending_requests[slot_index].request_id.store(0, std::memory_order_release); // Free the slot again
+        return false;
+    }
+    return true;
+}
+
 // Remove the old synchronous function
-// int process_data_with_python_sync(...) { ... } 
\ No newline at end of file
+// int process_data_with_python_sync(...) { ... }
\ No newline at end of file
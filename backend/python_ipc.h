@@ -12,60 +12,124 @@
 // Name for the shared memory segment (must match Python script)
 #define SHM_NAME_BI "/electron_python_shm_bi_123" // Bi-directional
 
-// MAX size definitions for EACH buffer direction
-const size_t SHM_C2A_BUFFER_MAX_SIZE = 1024;           // Creator -> Acceptor (TX)
-const size_t SHM_A2C_BUFFER_MAX_SIZE = 1024 * 1024 * 2; // Acceptor -> Creator (RX)
+// Number of message slots per direction (power of two, must match Python script)
+const size_t SHM_RING_SLOT_COUNT = 8;
 
-// --- Shared Memory Structure ---
-// IMPORTANT: Ensure total size and layout (including padding) EXACTLY 
+// DEFAULT size of EACH message slot per direction. These are only defaults:
+// init_acceptor_ipc_bidirectional takes the actual sizes at runtime and
+// publishes them in defined_c2a/a2c_buffer_size for the Acceptor to map.
+const size_t SHM_C2A_BUFFER_DEFAULT_SIZE = 64 * 1024;        // Creator -> Acceptor (TX), per slot
+const size_t SHM_A2C_BUFFER_DEFAULT_SIZE = 1024 * 1024 * 2;  // Acceptor -> Creator (RX), per slot
+
+// --- Message Ring (one per direction) ---
+// head/tail are free-running sequence numbers; slot index = seq % SLOT_COUNT.
+// The producer owns head, the consumer owns tail. A slot's payload and its
+// slot_len entry are fully written BEFORE head is advanced (release), so the
+// consumer can read them after observing the new head (acquire). This allows
+// up to SHM_RING_SLOT_COUNT messages in flight per direction instead of the
+// old one-slot lock-step handshake.
+struct ShmMsgRing {
+    std::atomic<uint64_t> head;                          // Next seq the producer publishes
+    std::atomic<uint64_t> tail;                          // Next seq the consumer reads
+    std::atomic<uint64_t> slot_len[SHM_RING_SLOT_COUNT]; // Payload length per slot
+    // Cross-process wakeup doorbells (32-bit futex words on Linux). The
+    // producer bumps data_doorbell after advancing head; the consumer bumps
+    // space_doorbell after advancing tail. Waiters sample the doorbell, then
+    // re-check the ring, then FUTEX_WAIT on the sampled value - so a publish
+    // between check and sleep can never be missed. On platforms without
+    // futexes both sides fall back to the previous 500us polling.
+    std::atomic<uint32_t> data_doorbell;
+    std::atomic<uint32_t> space_doorbell;
+};
+
+// --- Shared Memory Structure (control block only) ---
+// IMPORTANT: Ensure total size and layout (including padding) EXACTLY
 // matches the Python ctypes.Structure definition.
+// The data slots follow the 256-byte control block in the mapping:
+//   [control block 256B]
+//   [SLOT_COUNT x defined_c2a_buffer_size]  Creator -> Acceptor slots
+//   [SLOT_COUNT x defined_a2c_buffer_size]  Acceptor -> Creator slots
+// Slot sizes are chosen at init time and published in the control block, so
+// both sides derive the layout from what they read there, not from
+// compile-time constants.
 struct SharedIPCBidirectional {
-    // --- Control block --- 
-    // Atomics for status/commands
-    std::atomic<int32_t> c_to_a_command;  // 0: Idle, 1: Data Ready, 99: Shutdown
-    std::atomic<size_t>  c_to_a_data_len;
-    std::atomic<int32_t> a_to_c_status;   // 0: Idle, 1: Data Ready, -1: Error
-    std::atomic<size_t>  a_to_c_data_len;
-    // Defined buffer sizes (set by Creator, read by Acceptor)
-    size_t defined_c2a_buffer_size; // Actual usable size for buffer_c_to_a
-    size_t defined_a2c_buffer_size; // Actual usable size for buffer_a_to_c
-    
-    // Padding to ensure alignment and consistent control block size.
-    // Let's pad to 128 bytes for potential cache alignment benefits.
-    // Calculation assumes atomic<int32> is 4, atomic<size_t> is 8, size_t is 8.
-    // Current size = 4*2 + 8*2 + 8*2 = 8 + 16 + 16 = 40 bytes.
-    // Padding needed = 128 - 40 = 88 bytes.
-    char _padding1[128 - sizeof(std::atomic<int32_t>)*2 - sizeof(std::atomic<size_t>)*2 - sizeof(size_t)*2]; 
-    // --- End Control Block (Total 128 bytes) ---
-
-    // Data Buffers (Allocated based on MAX size constants)
-    char buffer_c_to_a[SHM_C2A_BUFFER_MAX_SIZE]; // Use TX max size
-    char buffer_a_to_c[SHM_A2C_BUFFER_MAX_SIZE]; // Use RX max size
+    std::atomic<int32_t> c_to_a_command;  // 0: Idle, 99: Shutdown
+    std::atomic<int32_t> a_to_c_status;   // 0: OK, -1: Acceptor error
+    // Readiness handshake: the Acceptor stores 1 here once it has mapped the
+    // segment and validated the layout. The Creator waits on this (bounded,
+    // see wait_for_acceptor_ready) instead of a blind startup sleep.
+    std::atomic<int32_t> acceptor_ready;
+    int32_t _reserved0;                   // Keeps the size_t fields 8-aligned
+    // Defined PER-SLOT buffer sizes (set by Creator, read by Acceptor)
+    size_t defined_c2a_buffer_size; // Usable size of each c_to_a slot
+    size_t defined_a2c_buffer_size; // Usable size of each a_to_c slot
+    uint64_t ring_slot_count;       // = SHM_RING_SLOT_COUNT, sanity-checked by Acceptor
+
+    ShmMsgRing c2a_ring; // Creator -> Acceptor messages
+    ShmMsgRing a2c_ring; // Acceptor -> Creator messages
+
+    // Padding to a fixed 256-byte control block (cache alignment + a stable
+    // offset for the data slots regardless of compiler).
+    char _padding1[256 - 3*sizeof(std::atomic<int32_t>) - sizeof(int32_t)
+                   - 2*sizeof(size_t) - sizeof(uint64_t)
+                   - 2*sizeof(ShmMsgRing)];
 };
 
 // Ensure the struct size calculation reflects the padding goal
-static_assert(sizeof(SharedIPCBidirectional::_padding1) == (128 - sizeof(std::atomic<int32_t>)*2 - sizeof(std::atomic<size_t>)*2 - sizeof(size_t)*2),
-              "Padding calculation error in SharedIPCBidirectional");
+static_assert(sizeof(ShmMsgRing) == 16 + 8 * SHM_RING_SLOT_COUNT + 8,
+              "Unexpected ShmMsgRing layout in SharedIPCBidirectional");
+static_assert(sizeof(SharedIPCBidirectional) == 256,
+              "Control block of SharedIPCBidirectional must be exactly 256 bytes");
+
+// Helpers mapping (direction, slot) to its buffer inside the shared mapping
+inline char* shm_c2a_slot(SharedIPCBidirectional* shm, size_t slot) {
+    return reinterpret_cast<char*>(shm) + sizeof(SharedIPCBidirectional)
+           + slot * shm->defined_c2a_buffer_size;
+}
+inline char* shm_a2c_slot(SharedIPCBidirectional* shm, size_t slot) {
+    return reinterpret_cast<char*>(shm) + sizeof(SharedIPCBidirectional)
+           + SHM_RING_SLOT_COUNT * shm->defined_c2a_buffer_size
+           + slot * shm->defined_a2c_buffer_size;
+}
+
+// --- Request/Response correlation ---
+// Every C->A message is stamped with a 4-byte request id (big endian) that
+// the acceptor echoes back at the front of its response. The originating
+// group_id/target_id are parked in a lock-free pending table keyed by that
+// id, so many requests can be in flight and each response is routed back
+// with its own context instead of a hardcoded placeholder group.
+const size_t IPC_REQUEST_ID_SIZE = sizeof(uint32_t);
+const size_t IPC_MAX_PENDING_REQUESTS = 64;
 
 // --- Callback Type for Received Data ---
 // This callback will be invoked by the C++ listener thread when data arrives from Python.
+// group_id/target_id are the values passed to send_request_to_acceptor_async for
+// the request this response answers (0/0 if the response could not be correlated).
 // It needs to handle copying the data and likely forwarding it to the JS layer.
 // IMPORTANT: This runs in a separate thread, ensure thread safety in the callback implementation!
-typedef std::function<void(const uint8_t* data, size_t length)> AcceptorDataCallback;
+typedef std::function<void(uint32_t group_id, uint32_t target_id,
+                           const uint8_t* data, size_t length)> AcceptorDataCallback;
 
 // --- IPC Management Functions ---
 
 /**
- * @brief Initializes the Bi-directional IPC channel using busy-wait flags.
+ * @brief Initializes the Bi-directional IPC channel (multi-slot ring per direction).
  * @param python_executable Path to the python executable.
  * @param script_path Path to the python_bidirectional_ipc_script.py.
  * @param callback The function to call when data is received from Python.
+ * @param c2a_slot_size Requested per-slot size for Creator->Acceptor messages.
+ * @param a2c_slot_size Requested per-slot size for Acceptor->Creator messages.
+ *        Both are published in the SHM control block for the Acceptor to map
+ *        dynamically. The segment is backed by huge pages when the platform
+ *        cooperates (best effort, see python_ipc.cc).
  * @return True on success, false on failure.
  */
 bool init_acceptor_ipc_bidirectional(
     const std::string& acceptor_executable,
     const std::string& acceptor_script_path,
-    AcceptorDataCallback callback
+    AcceptorDataCallback callback,
+    size_t c2a_slot_size = SHM_C2A_BUFFER_DEFAULT_SIZE,
+    size_t a2c_slot_size = SHM_A2C_BUFFER_DEFAULT_SIZE
 );
 
 /**
@@ -73,14 +137,36 @@ bool init_acceptor_ipc_bidirectional(
  */
 void shutdown_acceptor_ipc_bidirectional();
 
+/**
+ * @brief Bounded wait for the Acceptor's readiness flag in the SHM control
+ * block (set once it has mapped the segment and validated the layout).
+ * init_acceptor_ipc_bidirectional returns as soon as the Acceptor is
+ * spawned; call this when a caller actually needs the channel up.
+ * @param timeout_ms Maximum time to wait.
+ * @return True if the Acceptor signalled readiness within the timeout.
+ */
+bool wait_for_acceptor_ready(int timeout_ms);
+
 /**
  * @brief Sends data asynchronously to the Python process. (Non-blocking)
- * Writes data to the C->P buffer and signals Python via semaphore.
+ * Enqueues data into the next free C->A ring slot; only blocks (bounded)
+ * when all SHM_RING_SLOT_COUNT slots are in flight.
  * Does NOT wait for a response. Responses arrive via the PythonDataCallback.
  * @param input_data Pointer to the input data buffer.
  * @param input_len Length of the input data.
- * @return True if data was successfully written and signaled, false otherwise.
+ * @return True if data was successfully enqueued, false otherwise.
  */
 bool send_data_to_acceptor_async(const uint8_t* input_data, size_t input_len);
 
-#endif // PYTHON_IPC_H 
\ No newline at end of file
+/**
+ * @brief Like send_data_to_acceptor_async, but records the originating
+ * group_id/target_id in the pending-request table. The acceptor's response is
+ * delivered to the AcceptorDataCallback with these values, enabling multiple
+ * concurrent in-flight requests.
+ * @return True if data was successfully enqueued, false otherwise (including
+ *         when IPC_MAX_PENDING_REQUESTS responses are still outstanding).
+ */
+bool send_request_to_acceptor_async(uint32_t group_id, uint32_t target_id,
+                                    const uint8_t* input_data, size_t input_len);
+
+#endif // PYTHON_IPC_H
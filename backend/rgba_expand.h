@@ -0,0 +1,178 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+// --- Vectorized channel expansion helpers for HybridData_cvMat ---
+// Converts tightly-packed CV_8UC1 / CV_8UC3 pixel data to 4-channel output
+// with alpha forced to 255, matching the original scalar loops byte for byte
+// (the 3-channel variant copies channels in source order, it does NOT swap).
+//
+// x86: SSSE3 and AVX2 kernels selected at runtime via __builtin_cpu_supports,
+// compiled with per-function target attributes so no special build flags are
+// needed. Apple Silicon (Darwin-arm64 build): NEON, always available.
+// Everything falls back to the scalar loop.
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#elif defined(__aarch64__) || defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace rgba_expand {
+
+// --- Scalar fallbacks (identical to the original per-pixel loops) ---
+inline void gray_to_rgba_scalar(const uint8_t* src, uint8_t* dst, size_t pixel_count) {
+    for (size_t i = 0; i < pixel_count; i++) {
+        uint8_t pixel = *src++;
+        *dst++ = pixel;
+        *dst++ = pixel;
+        *dst++ = pixel;
+        *dst++ = 255;
+    }
+}
+
+inline void c3_to_c4_scalar(const uint8_t* src, uint8_t* dst, size_t pixel_count) {
+    for (size_t i = 0; i < pixel_count; i++) {
+        *dst++ = *src++;
+        *dst++ = *src++;
+        *dst++ = *src++;
+        *dst++ = 255;
+    }
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+
+// --- SSSE3: pshufb-based expansion, 16 input bytes per iteration ---
+__attribute__((target("ssse3")))
+inline void gray_to_rgba_ssse3(const uint8_t* src, uint8_t* dst, size_t pixel_count) {
+    const __m128i alpha = _mm_set1_epi32(0xFF000000);
+    // Each mask expands 4 gray bytes of the source register into p,p,p,_
+    const __m128i m0 = _mm_setr_epi8(0,0,0,-1, 1,1,1,-1, 2,2,2,-1, 3,3,3,-1);
+    const __m128i m1 = _mm_setr_epi8(4,4,4,-1, 5,5,5,-1, 6,6,6,-1, 7,7,7,-1);
+    const __m128i m2 = _mm_setr_epi8(8,8,8,-1, 9,9,9,-1, 10,10,10,-1, 11,11,11,-1);
+    const __m128i m3 = _mm_setr_epi8(12,12,12,-1, 13,13,13,-1, 14,14,14,-1, 15,15,15,-1);
+    size_t i = 0;
+    for (; i + 16 <= pixel_count; i += 16) {
+        __m128i g = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i * 4 + 0),  _mm_or_si128(_mm_shuffle_epi8(g, m0), alpha));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i * 4 + 16), _mm_or_si128(_mm_shuffle_epi8(g, m1), alpha));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i * 4 + 32), _mm_or_si128(_mm_shuffle_epi8(g, m2), alpha));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i * 4 + 48), _mm_or_si128(_mm_shuffle_epi8(g, m3), alpha));
+    }
+    gray_to_rgba_scalar(src + i, dst + i * 4, pixel_count - i);
+}
+
+__attribute__((target("ssse3")))
+inline void c3_to_c4_ssse3(const uint8_t* src, uint8_t* dst, size_t pixel_count) {
+    const __m128i alpha = _mm_set1_epi32(0xFF000000);
+    // 12 input bytes -> 4 output pixels, alpha slot filled via OR
+    const __m128i m = _mm_setr_epi8(0,1,2,-1, 3,4,5,-1, 6,7,8,-1, 9,10,11,-1);
+    size_t i = 0;
+    // The 16-byte load reads 4 bytes past the 12 consumed, so stop while at
+    // least 6 pixels (18 bytes) remain and let the scalar tail finish.
+    while (pixel_count - i >= 6) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 3));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i * 4), _mm_or_si128(_mm_shuffle_epi8(v, m), alpha));
+        i += 4;
+    }
+    c3_to_c4_scalar(src + i * 3, dst + i * 4, pixel_count - i);
+}
+
+// --- AVX2: 8 pixels per iteration via widening + multiply ---
+__attribute__((target("avx2")))
+inline void gray_to_rgba_avx2(const uint8_t* src, uint8_t* dst, size_t pixel_count) {
+    const __m256i splat = _mm256_set1_epi32(0x00010101); // p -> p,p,p,0
+    const __m256i alpha = _mm256_set1_epi32(0xFF000000);
+    size_t i = 0;
+    for (; i + 8 <= pixel_count; i += 8) {
+        __m128i g8 = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(src + i));
+        __m256i px = _mm256_cvtepu8_epi32(g8);
+        px = _mm256_or_si256(_mm256_mullo_epi32(px, splat), alpha);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i * 4), px);
+    }
+    gray_to_rgba_scalar(src + i, dst + i * 4, pixel_count - i);
+}
+
+__attribute__((target("avx2")))
+inline void c3_to_c4_avx2(const uint8_t* src, uint8_t* dst, size_t pixel_count) {
+    const __m256i alpha = _mm256_set1_epi32(0xFF000000);
+    // Per-lane shuffle: each 128-bit lane expands its own 12 bytes
+    const __m256i m = _mm256_setr_epi8(0,1,2,-1, 3,4,5,-1, 6,7,8,-1, 9,10,11,-1,
+                                       0,1,2,-1, 3,4,5,-1, 6,7,8,-1, 9,10,11,-1);
+    size_t i = 0;
+    // Two overlapping 16-byte lane loads consume 24 bytes (8 pixels); keep a
+    // scalar tail margin so the high lane's load never runs past the end.
+    while (pixel_count - i >= 11) {
+        __m256i v = _mm256_loadu2_m128i(reinterpret_cast<const __m128i*>(src + i * 3 + 12),
+                                        reinterpret_cast<const __m128i*>(src + i * 3));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i * 4),
+                            _mm256_or_si256(_mm256_shuffle_epi8(v, m), alpha));
+        i += 8;
+    }
+    c3_to_c4_scalar(src + i * 3, dst + i * 4, pixel_count - i);
+}
+
+#elif defined(__aarch64__) || defined(__ARM_NEON)
+
+// --- NEON: 8 pixels per iteration via interleaving stores ---
+inline void gray_to_rgba_neon(const uint8_t* src, uint8_t* dst, size_t pixel_count) {
+    const uint8x8_t alpha = vdup_n_u8(255);
+    size_t i = 0;
+    for (; i + 8 <= pixel_count; i += 8) {
+        uint8x8_t g = vld1_u8(src + i);
+        uint8x8x4_t out = { g, g, g, alpha };
+        vst4_u8(dst + i * 4, out);
+    }
+    gray_to_rgba_scalar(src + i, dst + i * 4, pixel_count - i);
+}
+
+inline void c3_to_c4_neon(const uint8_t* src, uint8_t* dst, size_t pixel_count) {
+    const uint8x8_t alpha = vdup_n_u8(255);
+    size_t i = 0;
+    for (; i + 8 <= pixel_count; i += 8) {
+        uint8x8x3_t v = vld3_u8(src + i * 3);
+        uint8x8x4_t out = { v.val[0], v.val[1], v.val[2], alpha };
+        vst4_u8(dst + i * 4, out);
+    }
+    c3_to_c4_scalar(src + i * 3, dst + i * 4, pixel_count - i);
+}
+
+#endif
+
+// --- Runtime dispatch (resolved once, on first use) ---
+using ExpandFn = void (*)(const uint8_t*, uint8_t*, size_t);
+
+inline ExpandFn resolve_gray_to_rgba() {
+#if defined(__x86_64__) || defined(__i386__)
+    if (__builtin_cpu_supports("avx2")) return gray_to_rgba_avx2;
+    if (__builtin_cpu_supports("ssse3")) return gray_to_rgba_ssse3;
+#elif defined(__aarch64__) || defined(__ARM_NEON)
+    return gray_to_rgba_neon;
+#endif
+    return gray_to_rgba_scalar;
+}
+
+inline ExpandFn resolve_c3_to_c4() {
+#if defined(__x86_64__) || defined(__i386__)
+    if (__builtin_cpu_supports("avx2")) return c3_to_c4_avx2;
+    if (__builtin_cpu_supports("ssse3")) return c3_to_c4_ssse3;
+#elif defined(__aarch64__) || defined(__ARM_NEON)
+    return c3_to_c4_neon;
+#endif
+    return c3_to_c4_scalar;
+}
+
+// Expands single-channel pixels to 4 channels (p,p,p,255).
+inline void gray_to_rgba(const uint8_t* src, uint8_t* dst, size_t pixel_count) {
+    static const ExpandFn fn = resolve_gray_to_rgba();
+    fn(src, dst, pixel_count);
+}
+
+// Expands 3-channel pixels to 4 channels (c0,c1,c2,255), channels untouched.
+inline void c3_to_c4(const uint8_t* src, uint8_t* dst, size_t pixel_count) {
+    static const ExpandFn fn = resolve_c3_to_c4();
+    fn(src, dst, pixel_count);
+}
+
+} // namespace rgba_expand
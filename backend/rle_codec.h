@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+
+// --- PackBits-style run-length codec for HybridData_cvMat ---
+// The fast lossless option for IM packets: camera frames with flat regions
+// (test cards, rendered overlays, dark scenes) collapse to a fraction of
+// their raw size at memcpy-like speed, and the worst case is bounded at
+// +1 byte per 128 input bytes - no entropy coding, no allocation.
+//
+// Stream format (classic PackBits):
+//   control 0..127   -> copy the next (control + 1) bytes literally
+//   control 129..255 -> repeat the next byte (257 - control) times
+//   control 128      -> unused / reserved
+namespace rle_codec {
+
+// Upper bound on encode() output for 'len' input bytes.
+inline size_t max_encoded_size(size_t len) {
+    return len + (len + 127) / 128 + 1;
+}
+
+// Encodes src[0..len) into dst (which must hold max_encoded_size(len)).
+// Returns the number of bytes written.
+inline size_t encode(const uint8_t* src, size_t len, uint8_t* dst) {
+    size_t out = 0;
+    size_t i = 0;
+    while (i < len) {
+        // Measure the run starting here (capped at the 128 a control encodes)
+        size_t run = 1;
+        while (run < 128 && i + run < len && src[i + run] == src[i]) ++run;
+        if (run >= 3) {
+            dst[out++] = static_cast<uint8_t>(257 - run);
+            dst[out++] = src[i];
+            i += run;
+            continue;
+        }
+        // Literal stretch: up to 128 bytes, stopping where a >=3 run starts
+        size_t start = i;
+        size_t lit = 0;
+        while (i < len && lit < 128) {
+            size_t r = 1;
+            while (r < 3 && i + r < len && src[i + r] == src[i]) ++r;
+            if (r >= 3) break;
+            ++i;
+            ++lit;
+        }
+        dst[out++] = static_cast<uint8_t>(lit - 1);
+        std::memcpy(dst + out, src + start, lit);
+        out += lit;
+    }
+    return out;
+}
+
+// Decodes src[0..len) into dst[0..dst_len). Returns the number of bytes
+// written, or 0 on a malformed/overflowing stream.
+inline size_t decode(const uint8_t* src, size_t len, uint8_t* dst, size_t dst_len) {
+    size_t in = 0;
+    size_t out = 0;
+    while (in < len) {
+        uint8_t control = src[in++];
+        if (control < 128) {
+            size_t count = static_cast<size_t>(control) + 1;
+            if (in + count > len || out + count > dst_len) return 0;
+            std::memcpy(dst + out, src + in, count);
+            in += count;
+            out += count;
+        } else if (control > 128) {
+            size_t count = 257 - static_cast<size_t>(control);
+            if (in >= len || out + count > dst_len) return 0;
+            std::memset(dst + out, src[in++], count);
+            out += count;
+        } else {
+            return 0; // Reserved control byte
+        }
+    }
+    return out;
+}
+
+} // namespace rle_codec
@@ -7,7 +7,13 @@
 #include <opencv2/opencv.hpp>
 #include <iomanip>
 #include <memory>
+#include <mutex>
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include <condition_variable>
 #include <dlfcn.h>
+#include <arpa/inet.h> // For htonl (pre-written BPG headers)
 #include "InspTarPluginInterface.h"
 #include <unistd.h>  // for getcwd
 
@@ -15,11 +21,24 @@
 #include "BPG_Protocol/bpg_decoder.h"
 #include "BPG_Protocol/bpg_encoder.h"
 #include "BPG_Protocol/bpg_types.h"
+#include "BPG_Protocol/bpg_logging.h"
+#include "BPG_Protocol/bpg_latency.h"
+#include "BPG_Protocol/hybrid_data_pool.h"
+#include "BPG_Protocol/packet_builder.h"
+#include "BPG_Protocol/tlv_metadata.h"
+#include "BPG_Protocol/group_dispatch.h"
 
 // Include our Python IPC header
 #include "python_ipc.h"
 
-BPG::AppPacket create_string_packet(uint32_t group_id, uint32_t target_id,std::string TL, std::string str);
+// Vectorized channel expansion kernels (runtime dispatched)
+#include "rgba_expand.h"
+#include "rle_codec.h"
+
+// Shared frame ring (plugin API v2 zero-copy display path)
+#include "frame_ring.h"
+
+BPG::AppPacket create_string_packet(uint32_t group_id, uint32_t target_id,const char* TL, std::string str);
 
 static MessageCallback g_send_message = nullptr;
 static BufferRequestCallback g_buffer_request_callback = nullptr;
@@ -30,17 +49,201 @@ static BPG::BpgDecoder g_bpg_decoder; // Decoder instance for this plugin
 static void* imgsrc_lib_handle = nullptr;
 static ITPIF_PluginInterface* imgsrc_interface = nullptr;
 static void* imgsrc_instance = nullptr;
-static ITPIF_ManagerInterface imgsrc_manager = {nullptr, nullptr, nullptr, nullptr, nullptr};
+static ITPIF_ManagerInterface imgsrc_manager = {nullptr, nullptr, nullptr, nullptr, nullptr, nullptr};
+
+// --- Frame buffer pool backing mgr_requestImg/mgr_releaseImg ---
+// Frames from the streaming path are all the same handful of sizes, so
+// instead of a malloc per frame (which was also never freed), buffers are
+// recycled through per-size free lists. Buffers are 64-byte aligned so SIMD
+// conversions and memcpy into the SharedArrayBuffer run on aligned lines.
+class FramePool {
+public:
+    void* acquire(size_t size) {
+        {
+            std::lock_guard<std::mutex> lock(mtx_);
+            auto it = free_lists_.find(size);
+            if (it != free_lists_.end() && !it->second.empty()) {
+                void* buf = it->second.back();
+                it->second.pop_back();
+                return buf;
+            }
+        }
+        void* buf = nullptr;
+        if (posix_memalign(&buf, 64, size) != 0) {
+            return nullptr;
+        }
+        return buf;
+    }
+
+    void release(void* buf, size_t size) {
+        if (!buf) return;
+        std::lock_guard<std::mutex> lock(mtx_);
+        auto& free_list = free_lists_[size];
+        if (free_list.size() >= kMaxFreePerSize) {
+            std::free(buf); // Pool already holds enough of this size
+            return;
+        }
+        free_list.push_back(buf);
+    }
+
+    ~FramePool() {
+        for (auto& entry : free_lists_) {
+            for (void* buf : entry.second) std::free(buf);
+        }
+    }
+
+private:
+    static constexpr size_t kMaxFreePerSize = 8; // Triple-buffering + headroom
+    std::mutex mtx_;
+    std::map<size_t, std::vector<void*>> free_lists_;
+};
+
+static FramePool g_frame_pool;
+
+// One SharedArrayBuffer region backs ALL producers: every claim->notify
+// cycle on g_buffer_request/send_callback is a critical section on the
+// transport, serialized here so routes' worker pools can produce
+// concurrently. The direct-frame path below holds it for its whole
+// claim->capture->notify window (stored in DirectFrameClaim).
+static std::mutex g_transport_mutex;
+
+// --- Direct-to-SharedArrayBuffer frame capture ---
+// Streaming frames used to make three passes over the pixels: capture into a
+// cv::Mat, copy into a HybridData_cvMat, then encode_binary_to into the wire
+// buffer. Here the host claims the outgoing SharedArrayBuffer region FIRST,
+// pre-writes the BPG "IM" header + metadata (payload size is known from the
+// requested dimensions), and hands the payload region down through
+// ITPIF_ImageInfo.buffer - the camera's capture/RGBA conversion writes its
+// one mandatory pass straight into the wire buffer. dispatch() then only has
+// to flush the already-encoded packet.
+struct DirectFrameClaim {
+    bool active = false;
+    uint8_t* wire_base = nullptr; // Start of the claimed buffer
+    size_t wire_size = 0;         // Header + metadata prefix + payload
+    uint8_t* payload = nullptr;   // Where the camera writes pixels
+    // Owns g_transport_mutex from claim to finish: the region stays claimed
+    // across the camera's capture pass, and every other sender's
+    // claim->notify cycle must queue behind it rather than interleave.
+    std::unique_lock<std::mutex> transport_lock;
+};
+static DirectFrameClaim g_direct_frame; // Streaming path is single-producer
+static std::mutex g_direct_frame_mtx;
+static std::atomic<uint32_t> g_stream_group_id{20000};
+static const int kDirectFrameRefId = 0x44495246; // 'DIRF', marks ImageInfo as wire-backed
+
+// Claims the output buffer and pre-encodes header + metadata. Returns false
+// (leaving 'info' untouched) when the buffer callbacks are unavailable or a
+// claim is already in flight, in which case the caller falls back to the pool.
+static bool claim_direct_frame(ITPIF_ImageInfo& info, int width, int height, int channels, int type) {
+    if (!g_buffer_request_callback || !g_buffer_send_callback) return false;
+    std::lock_guard<std::mutex> lock(g_direct_frame_mtx);
+    if (g_direct_frame.active) return false; // One wire claim at a time
+
+    // Like every other sender, the claim->notify cycle must own the
+    // transport - here the window spans the camera's capture pass. If the
+    // transport is mid-flush (batcher, worker pool, Python relay), fall
+    // back to the pooled path instead of stalling the stream thread.
+    std::unique_lock<std::mutex> transport_lock(g_transport_mutex, std::try_to_lock);
+    if (!transport_lock.owns_lock()) return false;
+
+    size_t payload_size = (size_t)width * height * channels;
+    // Metadata formatted on the stack (fmt-style appends, no std::string
+    // temporaries); the length must be known before the claim for sizing
+    uint8_t meta_buf[96];
+    BPG::BufferWriter metadata(meta_buf, sizeof(meta_buf));
+    metadata.append_literal("{\"width\":");
+    metadata.append_signed(width);
+    metadata.append_literal(",\"height\":");
+    metadata.append_signed(height);
+    metadata.append_literal(",\"channels\":");
+    metadata.append_signed(channels);
+    metadata.append_literal(",\"type\":");
+    metadata.append_signed(type);
+    metadata.append_literal(",\"format\":\"");
+    metadata.append_literal(channels == 4 ? "raw_rgba" : "raw");
+    metadata.append_literal("\"}");
+    size_t data_len = sizeof(uint32_t) + metadata.size() + payload_size;
+    size_t wire_size = BPG::BPG_HEADER_SIZE + data_len;
+
+    uint8_t* buffer = nullptr;
+    uint32_t buffer_size = 0;
+    if (g_buffer_request_callback(1000, &buffer, &buffer_size) != 0 || buffer == nullptr) {
+        return false;
+    }
+    if (buffer_size < wire_size) {
+        BPG_LOGW("[SamplePlugin DirectFrame] Claimed buffer too small (" << buffer_size
+                 << " < " << wire_size << "), falling back to pooled capture.");
+        g_buffer_send_callback(0); // Cancel the claim
+        return false;
+    }
+
+    BPG::BufferWriter writer(buffer, buffer_size);
+    BPG::PacketHeader header;
+    header.group_id = g_stream_group_id.fetch_add(1);
+    header.target_id = 1;
+    std::memcpy(header.tl, "IM", 2);
+    header.prop = BPG::BPG_PROP_EG_BIT_MASK; // Single-packet group
+    header.data_length = static_cast<uint32_t>(data_len);
+    header.encode(writer);
+    writer.append_uint32_network(static_cast<uint32_t>(metadata.size()));
+    writer.write(metadata.data(), metadata.size());
+
+    g_direct_frame.active = true;
+    g_direct_frame.wire_base = buffer;
+    g_direct_frame.wire_size = wire_size;
+    g_direct_frame.payload = buffer + writer.size();
+    g_direct_frame.transport_lock = std::move(transport_lock);
+
+    info.buffer = g_direct_frame.payload;
+    info.ref_id = kDirectFrameRefId;
+    return true;
+}
+
+// Flushes (send=true) or cancels (send=false) the in-flight wire claim.
+static void finish_direct_frame(bool send) {
+    std::lock_guard<std::mutex> lock(g_direct_frame_mtx);
+    if (!g_direct_frame.active) return;
+    g_buffer_send_callback(send ? static_cast<uint32_t>(g_direct_frame.wire_size) : 0);
+    // Resetting the claim releases g_transport_mutex (after the notify
+    // above), letting queued senders claim the region
+    g_direct_frame = DirectFrameClaim{};
+}
 
 // Manager callback stubs
-static int mgr_dispatch(void* main_ctx, struct ITPIF_StageInfo_c* data) { (void)main_ctx; (void)data; return 0; }
+static void mgr_releaseImg(void* main_ctx, ITPIF_ImageInfo* img);
+static int mgr_dispatch(void* main_ctx, struct ITPIF_StageInfo_c* data) {
+    (void)main_ctx;
+    if (!data) return 0;
+    if (data->img.ref_id == kDirectFrameRefId) {
+        // Wire-backed frame: header + metadata were pre-written and the camera
+        // filled the payload in place, so delivery is just the final flush.
+        finish_direct_frame(true);
+        data->img.buffer = nullptr;
+        return 0;
+    }
+    // Pooled frame: this host stub consumes it immediately; recycle its
+    // buffer so the streaming thread runs allocation-free at steady state.
+    mgr_releaseImg(main_ctx, &data->img);
+    return 0;
+}
 static cJSON* mgr_getNLockGlobalValue(void* main_ctx) { (void)main_ctx; return nullptr; }
 static void mgr_unLockGlobalValue(void* main_ctx) { (void)main_ctx; }
 static ITPIF_ImageInfo mgr_requestImg(void* main_ctx, int width, int height, int channels, int type) {
     (void)main_ctx;
     ITPIF_ImageInfo info = ITPIF_ImageInfoInit();
     size_t sz = width * height * channels * sizeof(uint8_t);
-    void* buf = std::malloc(sz);
+    // Prefer handing out the wire buffer itself (zero-intermediate-copy path)
+    if (claim_direct_frame(info, width, height, channels, type)) {
+        info.width = width;
+        info.height = height;
+        info.channels = channels;
+        info.step = width * channels * sizeof(uint8_t);
+        info.type = type;
+        info.elemSize = channels * sizeof(uint8_t);
+        info.totalSize = sz;
+        return info;
+    }
+    void* buf = g_frame_pool.acquire(sz);
     info.buffer = buf;
     info.width = width;
     info.height = height;
@@ -51,16 +254,56 @@ static ITPIF_ImageInfo mgr_requestImg(void* main_ctx, int width, int height, int
     info.totalSize = sz;
     return info;
 }
+static void mgr_releaseImg(void* main_ctx, ITPIF_ImageInfo* img) {
+    (void)main_ctx;
+    if (!img || !img->buffer) return;
+    if (img->ref_id == kDirectFrameRefId) {
+        // Releasing an undispatched wire-backed frame cancels the claim
+        finish_direct_frame(false);
+        img->buffer = nullptr;
+        return;
+    }
+    g_frame_pool.release(img->buffer, (size_t)img->totalSize);
+    img->buffer = nullptr;
+}
 static struct ITPIF_StageInfo_c mgr_requestStageInfo(void* main_ctx) { (void)main_ctx; struct ITPIF_StageInfo_c s = {}; return s; }
 
 class HybridData_cvMat:public BPG::HybridData{
     public:
     cv::Mat img;
+    // Codec selection, advertised verbatim in metadata_str:
+    //   "raw"       - pixels as stored in the Mat
+    //   "raw_rgba"  - expanded to RGBA (see rgba_expand.h)
+    //   "jpeg[:Q]"  - JPEG via cv::imencode, quality Q (default 85)
+    //   "rle_rgba"  - PackBits RLE of the RGBA plane (see rle_codec.h),
+    //                 fast lossless for flat/overlay-heavy frames
     std::string img_format;
+    HybridData_cvMat() = default; // Pooled instances are filled via set()
     HybridData_cvMat(cv::Mat img,std::string img_format):img(img),img_format(img_format){
         printf("HybridData_cvMat: %zu <<format: %s\n",calculateBinarySize(),img_format.c_str());
     }
 
+    void set(const cv::Mat& new_img, const std::string& new_format) {
+        img = new_img;
+        img_format = new_format;
+        codec_done = false;
+    }
+
+    // Drop the Mat reference on recycle so an idle pool slot does not pin a
+    // whole frame buffer. The codec buffers keep their capacity - that reuse
+    // is what makes per-frame compression allocation-free at steady state.
+    void recycleReset() override {
+        img.release();
+        img_format.clear();
+        codec_buf.clear();
+        codec_done = false;
+        BPG::HybridData::recycleReset();
+    }
+
+    bool isCodecFormat() const {
+        return img_format.rfind("jpeg", 0) == 0 || img_format == "rle_rgba";
+    }
+
     size_t calculateBinarySize() const {
         if(img_format=="raw"){
             return img.total()*img.elemSize();
@@ -68,6 +311,9 @@ class HybridData_cvMat:public BPG::HybridData{
         if(img_format=="raw_rgba"){
             return img.total()*4;
         }
+        if(isCodecFormat()){
+            return codecBytes().size();
+        }
         return 0;
     }
 
@@ -78,9 +324,7 @@ class HybridData_cvMat:public BPG::HybridData{
     BPG::BpgError encode_binary_to(BPG::BufferWriter& writer) const override {
         uint8_t* buffer = writer.claim_space(calculateBinarySize());
         if(buffer == nullptr) {
-             std::cerr << "[HybridData_cvMat ERR] Failed to claim space in buffer! Capacity: " 
-                       << writer.capacity() << ", Current Size: " << writer.size() 
-                       << ", Requested: " << calculateBinarySize() << std::endl;
+             BPG_LOGE("[HybridData_cvMat ERR] Failed to claim space in buffer! Capacity: " << writer.capacity() << ", Current Size: " << writer.size() << ", Requested: " << calculateBinarySize());
              return BPG::BpgError::BufferTooSmall; // Or another appropriate error
         }
         
@@ -93,27 +337,13 @@ class HybridData_cvMat:public BPG::HybridData{
             switch(img.type()){
                 case CV_8UC1:
                 {
-                    uint8_t* img_data = img.data;
-                    uint8_t* buffer_ptr = buffer;
-                    for(int i=0;i<img.total();i++){
-                        uint8_t pixel = *img_data++;
-                        *buffer_ptr++=pixel;
-                        *buffer_ptr++=pixel;
-                        *buffer_ptr++=pixel;
-                        *buffer_ptr++=255;
-                    }
+                    // SIMD (SSSE3/AVX2/NEON) with scalar fallback, see rgba_expand.h
+                    rgba_expand::gray_to_rgba(img.data, buffer, img.total());
                 }
                     break;
                 case CV_8UC3:
                 {
-                    uint8_t* img_data = img.data;
-                    uint8_t* buffer_ptr = buffer;
-                    for(int i=0;i<img.total();i++){
-                        *buffer_ptr++=*img_data++;
-                        *buffer_ptr++=*img_data++;
-                        *buffer_ptr++=*img_data++;
-                        *buffer_ptr++=255;
-                    }
+                    rgba_expand::c3_to_c4(img.data, buffer, img.total());
                 }
                     break;
                 case CV_8UC4:
@@ -124,109 +354,296 @@ class HybridData_cvMat:public BPG::HybridData{
             }
             return BPG::BpgError::Success;
         }
+        if(isCodecFormat()){
+            // Compressed payload. It cannot be produced straight into the
+            // wire here: the BPG header's data_length precedes the payload,
+            // so the exact compressed size must exist before the header is
+            // written. codecBytes() runs the codec once (triggered by the
+            // calculateEncodedSize call that sized the header) into a
+            // reusable scratch buffer; this is the single copy to the wire.
+            // The claim above already reserved codecBytes().size() bytes
+            // (calculateBinarySize IS the codec size for these formats).
+            const std::vector<uint8_t>& bytes = codecBytes();
+            std::memcpy(buffer, bytes.data(), bytes.size());
+            return BPG::BpgError::Success;
+        }
         return BPG::BpgError::EncodingError;
     }
+
+private:
+    mutable std::vector<uint8_t> codec_buf;   // Compressed payload cache
+    mutable std::vector<uint8_t> rgba_scratch; // RGBA plane staging for rle_rgba
+    mutable cv::Mat bgr_scratch;               // 3-channel staging for jpeg
+    mutable bool codec_done = false;
+
+    // Runs the selected codec once per set() and caches the result; both
+    // calculateBinarySize (header sizing) and encode_binary_to read it.
+    const std::vector<uint8_t>& codecBytes() const {
+        if (codec_done) return codec_buf;
+        codec_buf.clear();
+        if (img_format.rfind("jpeg", 0) == 0) {
+            int quality = 85;
+            size_t colon = img_format.find(':');
+            if (colon != std::string::npos) {
+                quality = std::max(1, std::min(100, atoi(img_format.c_str() + colon + 1)));
+            }
+            // imencode wants 1/3-channel input; drop alpha if present
+            const cv::Mat* src = &img;
+            if (img.channels() == 4) {
+                cv::cvtColor(img, bgr_scratch, cv::COLOR_BGRA2BGR);
+                src = &bgr_scratch;
+            }
+            if (!cv::imencode(".jpg", *src, codec_buf,
+                              {cv::IMWRITE_JPEG_QUALITY, quality})) {
+                BPG_LOGE("[HybridData_cvMat ERR] cv::imencode(jpeg) failed.");
+                codec_buf.clear();
+            }
+        } else { // rle_rgba
+            const uint8_t* plane = nullptr;
+            size_t plane_size = img.total() * 4;
+            if (img.type() == CV_8UC4 && img.isContinuous()) {
+                plane = img.data; // Already RGBA-shaped, compress in place
+            } else {
+                rgba_scratch.resize(plane_size);
+                switch (img.type()) {
+                    case CV_8UC1:
+                        rgba_expand::gray_to_rgba(img.data, rgba_scratch.data(), img.total());
+                        break;
+                    case CV_8UC3:
+                        rgba_expand::c3_to_c4(img.data, rgba_scratch.data(), img.total());
+                        break;
+                    case CV_8UC4: {
+                        cv::Mat dst(img.rows, img.cols, CV_8UC4, rgba_scratch.data());
+                        img.copyTo(dst); // Non-continuous source
+                        break;
+                    }
+                    default:
+                        BPG_LOGE("[HybridData_cvMat ERR] rle_rgba: unsupported Mat type " << img.type());
+                        plane_size = 0;
+                        break;
+                }
+                plane = rgba_scratch.data();
+            }
+            if (plane && plane_size > 0) {
+                codec_buf.resize(rle_codec::max_encoded_size(plane_size));
+                codec_buf.resize(rle_codec::encode(plane, plane_size, codec_buf.data()));
+            }
+        }
+        codec_done = true;
+        return codec_buf;
+    }
 };
 
-// --- BPG Callbacks --- 
+// --- Python -> renderer response relay ---
+// The response used to be encoded and sent inline on the IPC listener
+// thread, which kept the A2C ring slot claimed while blocking in
+// g_buffer_request_callback: renderer backpressure became backpressure on
+// the whole Python channel. The relay decouples them with an SPSC ring:
+// the listener copies the payload into a recycled slot (vector capacity is
+// retained, so the copy is a plain memcpy at steady state) and returns at
+// once - releasing the SHM slot back to Python - while a dedicated sender
+// thread drains the ring into BPG encode/send. head_/tail_ are the only
+// shared state on the data path; the mutex below exists purely to park and
+// wake the two threads, never to guard the payloads.
+class PythonResponseRelay {
+public:
+    void start() {
+        if (running_.exchange(true)) return;
+        sender_ = std::thread(&PythonResponseRelay::senderLoop, this);
+    }
 
-// Callback for data received FROM Python via the listener thread
-static void handle_python_data(const uint8_t* data, size_t length) {
-    std::cout << "[SamplePlugin PythonCallback] Received " << length << " bytes from Python listener." << std::endl;
-    
-    // TODO: Need context (like original group_id, target_id) to send a proper response.
-    // For now, just create a generic BPG packet with the received data.
-    // A more robust solution would involve associating requests with responses, 
-    // perhaps using a map or storing context when send_data_to_python_async is called.
-    uint32_t response_group_id = 999; // Placeholder group ID
-    uint32_t response_target_id = 1;   // Placeholder target ID
-    
-    BPG::AppPacketGroup response_group;
-    BPG::AppPacket resp_packet = create_string_packet(response_group_id, response_target_id, "PR", ""); // "PR" = Python Response
-    
-    // Check if data length exceeds capacity (shouldn't if SHM sizes match)
-    if (length > resp_packet.content->internal_binary_bytes.max_size()) {
-         std::cerr << "[SamplePlugin PythonCallback] Error: Received data length (" << length 
-                   << ") exceeds BPG packet binary buffer capacity." << std::endl;
-         // Optionally send an error status back to JS?
-         return;
+    // Drains whatever is still queued, then stops the sender. Call after the
+    // IPC listener is down (no producer may race this).
+    void stop() {
+        if (!running_.exchange(false)) return;
+        data_cv_.notify_all();
+        if (sender_.joinable()) sender_.join();
+        if (dropped_.load() > 0) {
+            BPG_LOGW("[SamplePlugin PyRelay] Dropped " << dropped_.load()
+                     << " Python response(s) to a stalled renderer.");
+        }
     }
-    
-    // Copy data into the BPG packet
-    resp_packet.content->internal_binary_bytes.assign(data, data + length); 
-    
-    response_group.push_back(resp_packet);
-    response_group.back().is_end_of_group = true;
-    
-    // Send the response group using the buffer callbacks
+
+    // Producer side (IPC listener thread only). Copies the payload and
+    // returns; blocks at most kFullWaitMs when the renderer has stalled the
+    // ring, then drops this response and counts it.
+    void submit(uint32_t group_id, uint32_t target_id,
+                const uint8_t* data, size_t length) {
+        uint64_t head = head_.load(std::memory_order_relaxed);
+        if (head - tail_.load(std::memory_order_acquire) >= kSlots) {
+            std::unique_lock<std::mutex> lock(wake_mtx_);
+            bool freed = space_cv_.wait_for(lock, std::chrono::milliseconds(kFullWaitMs),
+                [&] { return head - tail_.load(std::memory_order_acquire) < kSlots
+                             || !running_.load(); });
+            if (!freed || !running_.load()) {
+                dropped_.fetch_add(1, std::memory_order_relaxed);
+                BPG_LOGW("[SamplePlugin PyRelay] Relay ring full for " << kFullWaitMs
+                         << "ms; dropping response (group " << group_id << ").");
+                return;
+            }
+        }
+        Slot& slot = slots_[head & (kSlots - 1)];
+        slot.group_id = group_id;
+        slot.target_id = target_id;
+        slot.payload.assign(data, data + length);
+        head_.store(head + 1, std::memory_order_release);
+        { std::lock_guard<std::mutex> lock(wake_mtx_); } // Pair with the sender's predicate check
+        data_cv_.notify_one();
+    }
+
+    uint64_t droppedCount() const { return dropped_.load(std::memory_order_relaxed); }
+
+private:
+    struct Slot {
+        uint32_t group_id = 0;
+        uint32_t target_id = 0;
+        std::vector<uint8_t> payload; // Capacity retained across reuses
+    };
+
+    static const size_t kSlots = 16;     // Power of two
+    static const int kFullWaitMs = 250;  // Bound on producer-side blocking
+
+    void senderLoop() {
+        for (;;) {
+            uint64_t tail = tail_.load(std::memory_order_relaxed);
+            if (head_.load(std::memory_order_acquire) == tail) {
+                std::unique_lock<std::mutex> lock(wake_mtx_);
+                data_cv_.wait(lock, [&] {
+                    return head_.load(std::memory_order_acquire) != tail
+                           || !running_.load();
+                });
+                if (head_.load(std::memory_order_acquire) == tail
+                    && !running_.load()) break; // Drained and stopping
+                continue;
+            }
+            sendOne(slots_[tail & (kSlots - 1)]);
+            tail_.store(tail + 1, std::memory_order_release);
+            { std::lock_guard<std::mutex> lock(wake_mtx_); }
+            space_cv_.notify_one();
+        }
+    }
+
+    void sendOne(Slot& slot);
+
+    Slot slots_[kSlots];
+    std::atomic<uint64_t> head_{0}; // Producer-owned
+    std::atomic<uint64_t> tail_{0}; // Consumer-owned
+    std::atomic<uint64_t> dropped_{0};
+    std::atomic<bool> running_{false};
+    std::mutex wake_mtx_; // Parking only - never held around payload access
+    std::condition_variable data_cv_;
+    std::condition_variable space_cv_;
+    std::thread sender_;
+};
+
+static PythonResponseRelay g_python_relay;
+
+// Encodes one relayed Python response as a single-packet "PR" group and
+// flushes it through the shared transport (sender thread only).
+void PythonResponseRelay::sendOne(Slot& slot) {
+    BPG::AppPacket resp_packet = create_string_packet(slot.group_id, slot.target_id, "PR", ""); // "PR" = Python Response
+    resp_packet.is_end_of_group = true;
+
+    // The relay slot stays untouched until tail_ advances, so the payload is
+    // referenced in place - no second copy on the way to the wire.
+    resp_packet.content->setExternalBinary(slot.payload.data(), slot.payload.size());
+
     uint8_t* buffer = nullptr;
     uint32_t buffer_size = 0;
-    // Use a reasonable buffer size estimate
-    size_t estimated_size = BPG::BPG_HEADER_SIZE + resp_packet.content->calculateEncodedSize(); 
+    size_t estimated_size = BPG::BPG_HEADER_SIZE + resp_packet.content->calculateEncodedSize();
 
-    // Request buffer - Ensure callbacks are valid
     if (g_buffer_request_callback && g_buffer_send_callback) {
+        // Claim->notify is a critical section on the shared transport
+        std::lock_guard<std::mutex> transport_lock(g_transport_mutex);
         if (g_buffer_request_callback(estimated_size, &buffer, &buffer_size) == 0 && buffer != nullptr) {
             BPG::BufferWriter stream_writer(buffer, buffer_size);
-            BPG::BpgError encode_err = response_group[0].encode(stream_writer);
+            BPG::BpgError encode_err = resp_packet.encode(stream_writer);
             if (encode_err == BPG::BpgError::Success) {
                 g_buffer_send_callback(stream_writer.size());
-                std::cout << "   Sent Python result back via BPG (Group " << response_group_id << ")." << std::endl;
+                BPG_LOGD("   Sent Python result back via BPG (Group " << slot.group_id << ").");
             } else {
                 g_buffer_send_callback(0); // Indicate error by sending 0 size
-                std::cerr << "   Error encoding Python result BPG packet: " << static_cast<int>(encode_err) << std::endl;
+                BPG_LOGE("   Error encoding Python result BPG packet: " << static_cast<int>(encode_err));
             }
         } else {
-             std::cerr << "   Failed to get buffer for sending Python result." << std::endl;
+             BPG_LOGE("   Failed to get buffer for sending Python result.");
              g_buffer_send_callback(0); // Indicate error
         }
     } else {
-         std::cerr << "[SamplePlugin PythonCallback] Error: Buffer callbacks not available!" << std::endl;
+         BPG_LOGE("[SamplePlugin PyRelay] Error: Buffer callbacks not available!");
     }
 }
 
+// --- BPG Callbacks ---
+
+// Callback for data received FROM Python via the listener thread.
+// group_id/target_id come from the IPC request/response correlation table and
+// are the values of the originating TX packet (0/0 if uncorrelated).
+// Hands the payload to the relay ring and returns immediately so the SHM
+// slot goes back to Python without waiting on the renderer-facing buffer.
+static void handle_python_data(uint32_t group_id, uint32_t target_id,
+                               const uint8_t* data, size_t length) {
+    BPG_LOGD("[SamplePlugin PythonCallback] Received " << length << " bytes from Python listener (Group " << group_id << ", Target " << target_id << ").");
+
+    // Respond into the originating group; fall back to the old placeholder ids
+    // for uncorrelated (legacy) messages.
+    uint32_t response_group_id = (group_id != 0 || target_id != 0) ? group_id : 999;
+    uint32_t response_target_id = (group_id != 0 || target_id != 0) ? target_id : 1;
+
+    g_python_relay.submit(response_group_id, response_target_id, data, length);
+}
+
 // Example function to handle a fully decoded application packet
 static void handle_decoded_packet(const BPG::AppPacket& packet) {
-    std::cout << "[SamplePlugin BPG] Decoded Packet - Group: " << packet.group_id
-              << ", Target: " << packet.target_id
-              << ", Type: " << std::string(packet.tl, 2) << std::endl;
+    BPG_LOGT("[SamplePlugin BPG] Decoded Packet - Group: " << packet.group_id << ", Target: " << packet.target_id << ", Type: " << std::string(packet.tl, 2));
 
     if (!packet.content) {
-        std::cout << "    Content: <null>" << std::endl;
-        return; 
+        BPG_LOGT("    Content: <null>");
+        return;
     }
-    
-    std::cout << "    Meta: " << (packet.content->metadata_str.empty() ? "<empty>" : packet.content->metadata_str) << std::endl;
-    std::cout << "    Binary Size: " << packet.content->calculateEncodedSize() - sizeof(uint32_t) - packet.content->metadata_str.length() << std::endl; // Approx binary size
 
-    // Print binary content hex preview (up to 64 bytes)
-    if (!packet.content->internal_binary_bytes.empty()) {
-        std::cout << "    Binary Hex: ";
-        size_t print_len = std::min(packet.content->internal_binary_bytes.size(), (size_t)64);
+    BPG_LOGT("    Meta: " << (packet.content->metadata_str.empty() ? "<empty>" : packet.content->metadata_str));
+    BPG_LOGT("    Binary Size: " << packet.content->calculateEncodedSize() - sizeof(uint32_t) - packet.content->metadata_str.length()); // Approx binary size
+
+    // Binary content hex preview (up to 64 bytes), TRACE-only: this formatting
+    // ran for every packet and dominated the old per-packet logging cost.
+    // Use the view-aware accessors: the decoder's zero-copy fast path delivers
+    // payloads as views instead of filling internal_binary_bytes.
+#if BPG_LOG_COMPILE_LEVEL >= 4
+    if (packet.content->getBinarySize() > 0) {
+        const uint8_t* bin_data = packet.content->getBinaryData();
+        std::ostringstream hex_oss;
+        hex_oss << "    Binary Hex: " << std::hex << std::setfill('0');
+        size_t print_len = std::min(packet.content->getBinarySize(), (size_t)64);
         for (size_t i = 0; i < print_len; ++i) {
-            std::cout << std::hex << std::setw(2) << std::setfill('0') << static_cast<int>(packet.content->internal_binary_bytes[i]) << " ";
+            hex_oss << std::setw(2) << static_cast<int>(bin_data[i]) << " ";
         }
-        if (packet.content->internal_binary_bytes.size() > 64) {
-            std::cout << "...";
+        if (packet.content->getBinarySize() > 64) {
+            hex_oss << "...";
         }
-        std::cout << std::dec << std::endl; // Reset stream to decimal
+        BPG_LOGT(hex_oss.str());
     }
+#endif
 
     // --- Process TX packet via Python IPC (Now Asynchronous) ---
-    if (strncmp(packet.tl, "TX", 2) == 0 && packet.content && !packet.content->internal_binary_bytes.empty()) {
-        std::cout << "    -> Forwarding TX packet content to Python IPC (Async)..." << std::endl;
-        
-        // Send data asynchronously. The response will arrive via handle_python_data callback.
-        bool send_success = send_data_to_acceptor_async(
-            packet.content->internal_binary_bytes.data(),
-            packet.content->internal_binary_bytes.size()
+    if (strncmp(packet.tl, "TX", 2) == 0 && packet.content && packet.content->getBinarySize() > 0) {
+        BPG_LOGT("    -> Forwarding TX packet content to Python IPC (Async)...");
+
+        // Send data asynchronously with the packet's context recorded in the
+        // pending-request table. The response arrives via handle_python_data
+        // with the same group_id/target_id.
+        bool send_success = send_request_to_acceptor_async(
+            packet.group_id,
+            packet.target_id,
+            packet.content->getBinaryData(),
+            packet.content->getBinarySize()
         );
 
         if (!send_success) {
-            std::cerr << "    <- Error sending data to Python IPC via send_data_to_python_async." << std::endl;
+            BPG_LOGE("    <- Error sending data to Python IPC via send_data_to_python_async.");
             // Optionally send an immediate error back via BPG or log it
         } else {
-             std::cout << "    <- Data sent to Python asynchronously." << std::endl;
+             BPG_LOGT("    <- Data sent to Python asynchronously.");
         }
         // --- Remove the old synchronous result handling block ---
         // std::vector<uint8_t> python_result;
@@ -237,49 +654,66 @@ static void handle_decoded_packet(const BPG::AppPacket& packet) {
     // -----------------------------------------
 
     if (strncmp(packet.tl, "IM", 2) == 0) {
-        std::cout << "    (Packet is an Image)" << std::endl;
+        BPG_LOGT("    (Packet is an Image)");
     }
 }
 
 
-BPG::AppPacket create_image_packet(uint32_t group_id, uint32_t target_id, const cv::Mat& img, std::string img_format="") {
+// Pool for the image content wrappers - a recycled HybridData_cvMat keeps
+// its metadata string's capacity; the pixel data is only referenced, never
+// copied into the object.
+static BPG::HybridDataPool<HybridData_cvMat> g_cvmat_content_pool(8);
+
+// Fills a pooled image content object. The frame geometry goes out as
+// binary TLV fields (tlv_metadata.h) written in place into the pooled
+// metadata storage - no formatting on send, no JSON parse on receive, and
+// zero allocations per frame on a warm pool. The packet's prop field
+// advertises the format via BPG_PROP_TLV_META_BIT_MASK; low-rate packets
+// (AK/ST/...) keep JSON for debug readability.
+static std::shared_ptr<HybridData_cvMat> make_image_content(const cv::Mat& img,
+                                                            const std::string& img_format) {
+    auto content = g_cvmat_content_pool.acquire();
+    content->set(img, img_format);
+
+    BPG::BufferWriter meta = content->beginMetadata(
+        4 * BPG::TLV_U32_FIELD_SIZE + 2 + img_format.size());
+    BPG::TlvMetaWriter tlv(meta);
+    tlv.addU32(BPG::TLV_KEY_WIDTH, static_cast<uint32_t>(img.cols));
+    tlv.addU32(BPG::TLV_KEY_HEIGHT, static_cast<uint32_t>(img.rows));
+    tlv.addU32(BPG::TLV_KEY_CHANNELS, static_cast<uint32_t>(img.channels()));
+    tlv.addU32(BPG::TLV_KEY_PIXEL_TYPE, static_cast<uint32_t>(img.type()));
+    tlv.addString(BPG::TLV_KEY_FORMAT, img_format.c_str(), img_format.size());
+    content->commitMetadata(meta);
+    content->metadata_is_tlv = true;
+
+    BPG_LOGT("image metadata: TLV, " << content->metadata_str.size() << " bytes");
+    return content;
+}
+
+BPG::AppPacket create_image_packet(uint32_t group_id, uint32_t target_id, const cv::Mat& img, const std::string& img_format="") {
     BPG::AppPacket img_packet;
     img_packet.group_id = group_id;
     img_packet.target_id = target_id;
     std::memcpy(img_packet.tl, "IM", 2);
     img_packet.is_end_of_group = false;
-
-    // Create the derived object using make_shared
-    auto img_hybrid_data_ptr = std::make_shared<HybridData_cvMat>(img, img_format);
-    
-    // Set metadata on the object via the pointer
-    img_hybrid_data_ptr->metadata_str = 
-        "{\"width\":"+std::to_string(img.cols)+
-        ",\"height\":"+std::to_string(img.rows)+
-        ",\"channels\":"+std::to_string(img.channels())+
-        ",\"type\":"+std::to_string(img.type())+
-        ",\"format\":\""+img_format+"\"}";
-    
-
-    printf("metadata_str: %s\n",img_hybrid_data_ptr->metadata_str.c_str());
-    // Assign the shared_ptr to content
-    img_packet.content = img_hybrid_data_ptr;
+    img_packet.content = make_image_content(img, img_format);
     return img_packet;
 }
 
 
 
 
-BPG::AppPacket create_string_packet(uint32_t group_id, uint32_t target_id,std::string TL, std::string str){
+BPG::AppPacket create_string_packet(uint32_t group_id, uint32_t target_id,const char* TL, std::string str){
     BPG::AppPacket string_packet;
     string_packet.group_id = group_id;
     string_packet.target_id = target_id; // Use the provided target_id
-    std::memcpy(string_packet.tl, TL.c_str(), TL.size());
+    std::memcpy(string_packet.tl, TL, sizeof(BPG::PacketType));
     string_packet.is_end_of_group = false;
-    auto hybrid_data_ptr = std::make_shared<BPG::HybridData>();
-    
-    // Set metadata on the object via the pointer
-    hybrid_data_ptr->metadata_str = str;
+    // Recycled content object from the shared pool (see hybrid_data_pool.h)
+    auto hybrid_data_ptr = BPG::hybridDataPool().acquire();
+
+    // Metadata taken by move - callers hand over temporaries, not copies
+    hybrid_data_ptr->metadata_str = std::move(str);
     string_packet.content = hybrid_data_ptr;
     return string_packet;
 }
@@ -287,91 +721,371 @@ BPG::AppPacket create_string_packet(uint32_t group_id, uint32_t target_id,std::s
 // --- Example Sending Functions --- 
 
 
-int drawCounter=0;
-// NEW: Function to send a simple Acknowledgement Group
-static bool send_acknowledgement_group(uint32_t group_id, uint32_t target_id) {
-    if (!g_send_message) {
-        std::cerr << "[SamplePlugin BPG] Error: Cannot send ACK, g_send_message is null." << std::endl;
-        return false;
-    }
+// --- Scatter-gather group send (direct path) ---
+// Encodes a packet group across as many buffer_request/buffer_send cycles as
+// needed: each cycle packs as many WHOLE packets as the claimed region holds
+// and notifies once, so small packets coalesce into one send while a group
+// bigger than the SharedArrayBuffer region streams through in chunks at
+// packet boundaries instead of failing with BufferTooSmall.
+// Returns false if a single packet cannot fit the transport's region (a
+// packet cannot be split at this layer) or a claim/encode fails.
+//
+// Only each claim->notify cycle holds g_transport_mutex: packet sizing
+// runs first, which triggers any codec work (jpeg/RLE caches) outside the
+// lock, letting concurrent plugins overlap everything except the actual
+// buffer fill.
+//
+// Small groups do not come here - see SendBatcher / send_packet_group below.
+static bool send_packet_group_direct(const BPG::AppPacketGroup& group,
+                                     const std::vector<size_t>& packet_sizes) {
+    size_t next_packet = 0;
+    while (next_packet < group.size()) {
+        std::lock_guard<std::mutex> transport_lock(g_transport_mutex);
+        uint8_t* buffer = nullptr;
+        uint32_t buffer_size = 0;
+        if (g_buffer_request_callback(1000, &buffer, &buffer_size) != 0 || buffer == nullptr) {
+            BPG_LOGE("[SamplePlugin BPG] Error: Failed to claim send buffer (packet "
+                     << next_packet << "/" << group.size() << ").");
+            return false;
+        }
 
-    std::cout << "[SamplePlugin BPG] Encoding and Sending ACK Group ID: " << group_id << std::endl;
-    BPG::AppPacketGroup group_to_send;
+        BPG::BufferWriter writer(buffer, buffer_size);
+        size_t packed = 0;
+        while (next_packet < group.size()) {
+            const BPG::AppPacket& packet = group[next_packet];
+            size_t packet_size = packet_sizes[next_packet];
+            if (packet_size > writer.remaining()) break; // Next cycle
+            BPG::BpgError encode_err = packet.encode(writer);
+            if (encode_err != BPG::BpgError::Success) {
+                BPG_LOGE("[SamplePlugin BPG] Error encoding packet " << next_packet
+                         << " (TL " << std::string(packet.tl, 2) << "): "
+                         << static_cast<int>(encode_err));
+                g_buffer_send_callback(0);
+                return false;
+            }
+            ++next_packet;
+            ++packed;
+        }
 
-    {
-        // --- Construct IM Packet ---
+        if (packed == 0) {
+            // Even an empty region couldn't hold the next packet
+            BPG_LOGE("[SamplePlugin BPG] Error: Packet " << next_packet << " ("
+                     << packet_sizes[next_packet]
+                     << " bytes) exceeds the transport buffer (" << buffer_size
+                     << " bytes); group dropped.");
+            g_buffer_send_callback(0);
+            return false;
+        }
 
-        cv::Mat img(600,800,CV_8UC4,cv::Scalar(0,0,255,100));
-        // draw text on the image
-        cv::putText(img, "Hello, World!"+std::to_string(drawCounter++), cv::Point(10,50), cv::FONT_HERSHEY_SIMPLEX, 1, cv::Scalar(0,0,0,255), 2);
-        group_to_send.push_back(
-            create_image_packet(group_id, target_id, 
-        img, 
-        "raw_rgba")
-        );
+        BPG_LOGD("[SamplePlugin BPG] Sending " << packed << " packet(s), "
+                 << writer.size() << " bytes (" << next_packet << "/" << group.size() << ").");
+        g_buffer_send_callback(writer.size());
     }
+    return true;
+}
 
+// --- Adaptive small-packet batching ---
+// Every group used to cost a full claim->notify cycle even when it was a
+// few dozen bytes ("AK" acks, status strings, FR frame notifications), and
+// the renderer paid one cross-isolate wakeup plus a decode-loop walk per
+// notification. The batcher puts a staging buffer in front of the
+// transport: small groups encode into it and it flushes on
+//   - a size threshold (kFlushBytes),
+//   - a group-complete (EG) boundary, or
+//   - a sub-millisecond deadline (kFlushDeadlineUs, flusher thread)
+//     for anything staged without its EG yet.
+// The EG flush keeps single-request latency at one notify; the burst win
+// comes from the transport mutex: while one thread's flush holds the
+// claim, other threads stage their groups, and whichever EG flush runs
+// next drains ALL of them in one cycle - a start/stop storm from the UI
+// collapses into a handful of notifications.
+class SendBatcher {
+public:
+    void start() {
+        if (running_.exchange(true)) return;
+        staging_.resize(kStagingCapacity);
+        used_ = 0;
+        flusher_ = std::thread(&SendBatcher::flusherLoop, this);
+    }
 
+    // Flushes whatever is staged, then stops the flusher.
+    void stop() {
+        if (!running_.exchange(false)) return;
+        cv_.notify_all();
+        if (flusher_.joinable()) flusher_.join();
+        std::unique_lock<std::mutex> lock(mtx_);
+        cv_.wait(lock, [&] { return !flush_in_flight_; }); // Late sender's flush
+        if (used_ > 0) flushDrain(lock);
+    }
 
+    // Stages a whole group (caller guarantees the encoded size fits the
+    // staging buffer - see send_packet_group). Flushes per the policy
+    // above. Thread-safe.
+    bool sendGroup(const BPG::AppPacketGroup& group, size_t total_size) {
+        std::unique_lock<std::mutex> lock(mtx_);
+        while (used_ + total_size > staging_.size()) {
+            // Make room first so the group stays contiguous in one flush
+            if (flush_in_flight_) {
+                cv_.wait(lock, [&] { return !flush_in_flight_; });
+                continue;
+            }
+            if (!flushDrain(lock)) return false;
+        }
+        BPG::BufferWriter writer(staging_.data() + used_, staging_.size() - used_);
+        for (const BPG::AppPacket& packet : group) {
+            if (packet.encode(writer) != BPG::BpgError::Success) {
+                BPG_LOGE("[SamplePlugin Batch] Error encoding packet (TL "
+                         << std::string(packet.tl, 2) << "); group dropped.");
+                return false; // Staged bytes before this group remain valid
+            }
+        }
+        used_ += writer.size();
+        bool at_eg = !group.empty() && group.back().is_end_of_group;
+        if (used_ >= kFlushBytes || at_eg) {
+            // A flush already holding the transport claim will re-check the
+            // staging after it lands and drain our bytes with it - THIS is
+            // where a burst of small groups collapses into one notification.
+            if (flush_in_flight_) {
+                flush_requested_ = true;
+                return true;
+            }
+            return flushDrain(lock);
+        }
+        // Partial group staged: arm the deadline flusher
+        cv_.notify_one();
+        return true;
+    }
 
+private:
+    static const size_t kStagingCapacity = 16 * 1024;
+    static const size_t kFlushBytes = 8 * 1024;
+    static const int kFlushDeadlineUs = 500;
+
+    // Flushes and keeps flushing while more flush-worthy bytes accumulated
+    // during the claim->notify cycle (deferred EG flushes from other
+    // threads). Called with mtx_ held and flush_in_flight_ false.
+    bool flushDrain(std::unique_lock<std::mutex>& lock) {
+        bool ok = true;
+        flush_in_flight_ = true;
+        do {
+            flush_requested_ = false;
+            ok = flushOnce(lock) && ok;
+        } while (flush_requested_ && used_ > 0);
+        flush_in_flight_ = false;
+        cv_.notify_all(); // Wake stagers waiting for room
+        return ok;
+    }
 
-    {
-        group_to_send.push_back(
-            create_string_packet(group_id, target_id,"AK","{\"received\":true}")
-        );
+    // Swaps the staged bytes out (so stagers keep appending while the
+    // transport claim is held) and pushes them through one claim->notify
+    // cycle. Called with mtx_ held; drops and reacquires it around the
+    // transport work.
+    bool flushOnce(std::unique_lock<std::mutex>& lock) {
+        if (used_ == 0) return true;
+        staging_.swap(flush_buf_);
+        size_t flush_size = used_;
+        used_ = 0;
+        if (staging_.size() != kStagingCapacity) staging_.resize(kStagingCapacity);
+        lock.unlock();
+
+        bool ok = false;
+        {
+            std::lock_guard<std::mutex> transport_lock(g_transport_mutex);
+            uint8_t* buffer = nullptr;
+            uint32_t buffer_size = 0;
+            if (g_buffer_request_callback
+                && g_buffer_request_callback(1000, &buffer, &buffer_size) == 0
+                && buffer != nullptr) {
+                if (flush_size <= buffer_size) {
+                    std::memcpy(buffer, flush_buf_.data(), flush_size);
+                    g_buffer_send_callback(flush_size);
+                    ok = true;
+                } else {
+                    BPG_LOGE("[SamplePlugin Batch] Staged " << flush_size
+                             << " bytes exceed the transport buffer (" << buffer_size
+                             << "); batch dropped.");
+                    g_buffer_send_callback(0);
+                }
+            } else {
+                BPG_LOGE("[SamplePlugin Batch] Failed to claim send buffer for batch.");
+            }
+        }
 
+        lock.lock();
+        return ok;
+    }
 
+    void flusherLoop() {
+        std::unique_lock<std::mutex> lock(mtx_);
+        while (running_.load()) {
+            if (used_ == 0) {
+                cv_.wait(lock, [&] { return used_ > 0 || !running_.load(); });
+                continue;
+            }
+            // Something is staged without its EG (or below the threshold):
+            // bound how long it can sit before the renderer hears about it
+            cv_.wait_for(lock, std::chrono::microseconds(kFlushDeadlineUs),
+                         [&] { return !running_.load() || flush_in_flight_; });
+            if (used_ > 0 && !flush_in_flight_) flushDrain(lock);
+        }
     }
 
-    //set last packet as end of group
-    group_to_send.back().is_end_of_group = true;
+    std::mutex mtx_; // Guards staging_/used_ and the flush flags
+    std::condition_variable cv_;
+    std::vector<uint8_t> staging_;
+    std::vector<uint8_t> flush_buf_; // Swap target while the claim is held
+    size_t used_ = 0;
+    bool flush_in_flight_ = false;  // A thread is inside claim->notify
+    bool flush_requested_ = false;  // EG flush deferred to the in-flight thread
+    std::atomic<bool> running_{false};
+    std::thread flusher_;
+};
+
+static SendBatcher g_send_batcher;
 
-    // --- Calculate Size and Create Buffer/Writer ---
-    size_t total_estimated_size = 0;
-    for(const auto& packet : group_to_send) {
-        if (packet.content) { 
-            // printf("packet.content->calculateEncodedSize(): %zu\n",packet.content->calculateEncodedSize());
-            total_estimated_size += BPG::BPG_HEADER_SIZE + packet.content->calculateEncodedSize();
-        } else {
-            total_estimated_size += BPG::BPG_HEADER_SIZE; 
-        }
+// Groups whose encoded size fits this stage through the batcher; larger
+// ones (image payloads) go straight to the scatter-gather path, where the
+// payload memcpy dwarfs the notification cost anyway.
+static const size_t kBatchableGroupBytes = 4 * 1024;
+
+// Routes a group to the batcher or the direct path based on its encoded
+// size. All senders come through here.
+static bool send_packet_group(const BPG::AppPacketGroup& group) {
+    if (!g_buffer_request_callback || !g_buffer_send_callback) {
+        BPG_LOGE("[SamplePlugin BPG] Error: Buffer callbacks not available, cannot send group.");
+        return false;
+    }
+    BPG::ScopedLatencyTimer send_timer(BPG::LatencyStage::kEncodeSend);
+
+    // Size every packet up front (outside the transport lock; runs codecs)
+    std::vector<size_t> packet_sizes(group.size());
+    size_t total_size = 0;
+    for (size_t i = 0; i < group.size(); ++i) {
+        packet_sizes[i] = BPG::BPG_HEADER_SIZE
+                        + (group[i].content ? group[i].content->calculateEncodedSize() : 0);
+        total_size += packet_sizes[i];
     }
 
-    // --- Request Buffer ---
-    uint8_t* buffer = nullptr;
-    uint32_t buffer_size = 0;
-    g_buffer_request_callback(1000,&buffer, &buffer_size);
+    if (total_size <= kBatchableGroupBytes) {
+        return g_send_batcher.sendGroup(group, total_size);
+    }
+    return send_packet_group_direct(group, packet_sizes);
+}
 
-    BPG::BufferWriter stream_writer(buffer, buffer_size);
+int drawCounter=0;
 
+// --- Shared frame ring (plugin API v2) ---
+// When the host grants a ring (setup_frame_ring below), frames bypass the
+// BPG payload path entirely: pixels are written in place into a shared
+// slot and the group carries only a constant-size "FR" notification with
+// (slot, generation) TLV metadata. Without a ring - v1 hosts - the "IM"
+// inline path below is used unchanged.
+static frame_ring::FrameRingWriter g_frame_ring;
+// The writer is single-producer (see frame_ring.h) but groups are built by
+// the route's dispatcher pool (2 workers) - the beginFrame->publish window,
+// pixel write included, is serialized here. Interleaved writers could land
+// in the same slot and publish even generations the renderer's seqlock
+// check cannot tell apart from a clean frame.
+static std::mutex g_frame_ring_mtx;
+static const uint32_t kFrameRingSlots = 3;
+// Room for a 1080p RGBA frame per slot
+static const uint32_t kFrameRingSlotSize =
+    sizeof(frame_ring::SlotHeader) + 1920u * 1080u * 4u;
+
+// Expands a Mat into tightly-packed RGBA at 'dst' (same conversions as the
+// inline raw_rgba encode path).
+static void write_rgba_frame(const cv::Mat& img, uint8_t* dst) {
+    switch (img.type()) {
+        case CV_8UC1:
+            rgba_expand::gray_to_rgba(img.data, dst, img.total());
+            break;
+        case CV_8UC3:
+            rgba_expand::c3_to_c4(img.data, dst, img.total());
+            break;
+        case CV_8UC4:
+            if (img.isContinuous()) {
+                std::memcpy(dst, img.data, img.total() * 4);
+            } else {
+                cv::Mat wrap(img.rows, img.cols, CV_8UC4, dst);
+                img.copyTo(wrap);
+            }
+            break;
+        default:
+            BPG_LOGE("[SamplePlugin FrameRing] Unsupported Mat type " << img.type());
+            break;
+    }
+}
 
+// One reusable group composer per sending thread (dispatcher workers build
+// groups concurrently). The builder keeps its vector - and, through the
+// pools, each packet's capacities - warm across frames, so composing a
+// group here settles at zero heap allocations. See packet_builder.h.
+static thread_local BPG::GroupBuilder t_group_builder;
 
-    // --- Encode the Group into the Writer ---
-    // write packets back to back
-    bool success = true;
-    for (const auto& packet : group_to_send) { 
-        uint8_t* buffer_ptr = stream_writer.raw_data()+stream_writer.currentPosition();
-        memset(buffer_ptr,0,200);
-        printf("encoding packet: %s, group_id: %d\n",std::string(packet.tl, 2).c_str(),packet.group_id);
-        BPG::BpgError encode_err = packet.encode(stream_writer);
+// NEW: Function to send a simple Acknowledgement Group
+static bool send_acknowledgement_group(uint32_t group_id, uint32_t target_id) {
+    if (!g_send_message) {
+        BPG_LOGE("[SamplePlugin BPG] Error: Cannot send ACK, g_send_message is null.");
+        return false;
+    }
 
+    BPG_LOGD("[SamplePlugin BPG] Encoding and Sending ACK Group ID: " << group_id);
+    t_group_builder.begin(group_id, target_id, 2);
 
-        if (encode_err != BPG::BpgError::Success) {
-            std::cerr << "[SamplePlugin BPG] Error encoding ACK packet: " << static_cast<int>(encode_err) << std::endl;
-            success = false;
-            break; // Exit loop on error
+    {
+        // --- Construct frame packet (ring slot or inline IM) ---
+
+        cv::Mat img(600,800,CV_8UC4,cv::Scalar(0,0,255,100));
+        // draw text on the image
+        cv::putText(img, "Hello, World!"+std::to_string(drawCounter++), cv::Point(10,50), cv::FONT_HERSHEY_SIMPLEX, 1, cv::Scalar(0,0,0,255), 2);
+
+        bool ring_published = false;
+        frame_ring::Publication pub{};
+        {
+            // Single-producer writer, multiple dispatcher workers: hold the
+            // ring mutex across beginFrame->publish (see g_frame_ring_mtx)
+            std::lock_guard<std::mutex> ring_lock(g_frame_ring_mtx);
+            uint8_t* slot_pixels = g_frame_ring.beginFrame(img.total() * 4);
+            if (slot_pixels) {
+                // Pixels go straight into the shared slot; the packet is
+                // just a (slot, generation) notification the renderer
+                // resolves against the ring, re-checking the generation
+                // for torn reads.
+                write_rgba_frame(img, slot_pixels);
+                pub = g_frame_ring.publish(img.cols, img.rows, CV_8UC4);
+                ring_published = true;
+            }
+        }
+        if (ring_published) {
+            BPG::AppPacket& fr = t_group_builder.add("FR");
+            BPG::BufferWriter meta = fr.content->beginMetadata(
+                4 * BPG::TLV_U32_FIELD_SIZE + 2 + 8);
+            BPG::TlvMetaWriter tlv(meta);
+            tlv.addU32(BPG::TLV_KEY_SLOT, pub.slot);
+            tlv.addU32(BPG::TLV_KEY_GENERATION, pub.generation);
+            tlv.addU32(BPG::TLV_KEY_WIDTH, static_cast<uint32_t>(img.cols));
+            tlv.addU32(BPG::TLV_KEY_HEIGHT, static_cast<uint32_t>(img.rows));
+            tlv.addString(BPG::TLV_KEY_FORMAT, "raw_rgba");
+            fr.content->commitMetadata(meta);
+            fr.content->metadata_is_tlv = true;
+        } else {
+            // No ring (v1 host) or frame too large: inline payload
+            t_group_builder.add("IM", make_image_content(img, "raw_rgba"));
         }
     }
 
-    // --- Send the Entire Buffer ---
-    if (success) {
-         std::cout << "  Sending ACK Group (ID: " << group_id << "), Total Size: " << stream_writer.size() << std::endl;
-        //  g_send_message(stream_writer.data(), stream_writer.size());
-        g_buffer_send_callback(stream_writer.size());
-    }
-    else
     {
-        g_buffer_send_callback(0);
+        // --- Construct AK Packet (metadata formatted in place, no string) ---
+        BPG::AppPacket& ack = t_group_builder.add("AK");
+        BPG::BufferWriter meta = ack.content->beginMetadata(32);
+        meta.append_literal("{\"received\":true}");
+        ack.content->commitMetadata(meta);
+    }
+
+    // --- Encode + Send (scatter-gather, chunks at packet boundaries) ---
+    bool success = send_packet_group(t_group_builder.finish());
+    if (success) {
+        BPG_LOGD("  Sent ACK Group (ID: " << group_id << ", " << t_group_builder.size() << " packets).");
     }
 
     return success; // Return overall success/failure
@@ -379,31 +1093,110 @@ static bool send_acknowledgement_group(uint32_t group_id, uint32_t target_id) {
 
 // Example function to handle a completed packet group
 static void handle_decoded_group(uint32_t group_id, BPG::AppPacketGroup&& group) {
-     std::cout << "[SamplePlugin BPG] Decoded COMPLETE Group - ID: " << group_id 
-               << ", Packet Count: " << group.size() << std::endl;
+     BPG_LOGD("[SamplePlugin BPG] Decoded COMPLETE Group - ID: " << group_id << ", Packet Count: " << group.size());
     
     // --- TODO: Add application logic for the complete group --- 
     for(const auto& packet : group) {
-         std::cout << "    - Packet Type in Group: " << std::string(packet.tl, 2) << std::endl;
+         BPG_LOGT("    - Packet Type in Group: " << std::string(packet.tl, 2));
          if (packet.content) {
-             std::cout << "      Meta: " << (packet.content->metadata_str.empty() ? "<empty>" : packet.content->metadata_str) << std::endl;
-             std::cout << "      Binary Size: " << packet.content->calculateEncodedSize() - sizeof(uint32_t) - packet.content->metadata_str.length() << std::endl; // Approx binary size
+             BPG_LOGT("      Meta: " << (packet.content->metadata_str.empty() ? "<empty>" : packet.content->metadata_str));
+             BPG_LOGT("      Binary Size: " << packet.content->calculateEncodedSize() - sizeof(uint32_t) - packet.content->metadata_str.length()); // Approx binary size
          } else {
-             std::cout << "      Content: <null>" << std::endl;
+             BPG_LOGT("      Content: <null>");
          }
     }
 
-    // --- Echo Back Logic --- 
+    // --- Stats Request ("ST") ---
+    // Replies with the per-stage latency histograms so the frontend can
+    // render a live breakdown. No ACK/image rendering for these.
+    if (!group.empty() && strncmp(group[0].tl, "ST", 2) == 0) {
+        // Splice the decoder's housekeeping counter into the stats object
+        std::string stats_json = BPG::LatencyStats::instance().toJson();
+        stats_json.insert(1, "\"group_timeouts\":"
+                             + std::to_string(g_bpg_decoder.timedOutGroupCount()) + ",");
+        t_group_builder.begin(group_id, group[0].target_id, 1);
+        t_group_builder.add("ST").content->metadata_str = std::move(stats_json);
+        send_packet_group(t_group_builder.finish());
+        return;
+    }
+
+    // --- Echo Back Logic ---
     if (!group.empty()) {
         uint32_t original_target_id = group[0].target_id; // Assuming target_id is same for the group
         uint32_t response_target_id = original_target_id;
         send_acknowledgement_group(group_id, response_target_id); // Send ACK back
     } else {
-         std::cerr << "[SamplePlugin BPG] Warning: Received empty group (ID: " << group_id << "), cannot echo back." << std::endl;
+         BPG_LOGW("[SamplePlugin BPG] Warning: Received empty group (ID: " << group_id << "), cannot echo back.");
     }
 }
 
-// --- Plugin Interface Implementation --- 
+// --- Target routing table ---
+// Every decoded packet carries a target_id; backends register against
+// inclusive target_id ranges, and each route owns its own GroupDispatcher
+// (worker pool + queues). Decoded groups are submitted to their owner's
+// queue, so adding a plugin instance adds cores to the backend instead of
+// contending on one global pool. Routes match in registration order; the
+// built-in echo/stats handler is registered last as the catch-all.
+struct TargetRoute {
+    uint32_t lo;       // Inclusive target_id range
+    uint32_t hi;
+    std::string name;  // For logs
+    std::unique_ptr<BPG::GroupDispatcher> dispatcher;
+};
+
+class TargetRouter {
+public:
+    void registerRoute(uint32_t lo, uint32_t hi, std::string name,
+                       BPG::GroupDispatcher::GroupHandler handler,
+                       size_t workers = 2, size_t queue_capacity = 64) {
+        std::lock_guard<std::mutex> lock(mtx_);
+        BPG_LOGI("[SamplePlugin Router] Route '" << name << "' owns targets ["
+                 << lo << ", " << hi << "] (" << workers << " workers).");
+        routes_.push_back(TargetRoute{lo, hi, std::move(name),
+            std::unique_ptr<BPG::GroupDispatcher>(
+                new BPG::GroupDispatcher(std::move(handler), workers, queue_capacity))});
+    }
+
+    // Owner's queue for a target_id, or nullptr when nothing is registered
+    // (pre-init). Registration happens at bring-up, not per packet, so the
+    // lock here is uncontended in steady state.
+    BPG::GroupDispatcher* route(uint32_t target_id) {
+        std::lock_guard<std::mutex> lock(mtx_);
+        for (auto& r : routes_) {
+            if (target_id >= r.lo && target_id <= r.hi) return r.dispatcher.get();
+        }
+        return nullptr;
+    }
+
+    // Drains and destroys every route's dispatcher.
+    void clear() {
+        std::lock_guard<std::mutex> lock(mtx_);
+        routes_.clear();
+    }
+
+private:
+    std::mutex mtx_;
+    std::vector<TargetRoute> routes_;
+};
+
+static TargetRouter g_target_router;
+
+// Dispatch stage between decode and the group handlers: handlers render
+// images and block on g_buffer_request_callback, so running them on the
+// decode thread stalled the SharedArrayBuffer drain loop. Groups go to the
+// worker pool of whichever route owns their target_id (per-group_id
+// ordering preserved by each dispatcher's hashing).
+static void dispatch_decoded_group(uint32_t group_id, BPG::AppPacketGroup&& group) {
+    uint32_t target_id = group.empty() ? 0 : group[0].target_id;
+    BPG::GroupDispatcher* owner = g_target_router.route(target_id);
+    if (owner) {
+        owner->submit(group_id, std::move(group));
+    } else {
+        handle_decoded_group(group_id, std::move(group)); // Pre-init fallback
+    }
+}
+
+// --- Plugin Interface Implementation ---
 
 static PluginInfo plugin_info = {
     "Sample Plugin (BPG + Python IPC)", // Updated name
@@ -411,71 +1204,106 @@ static PluginInfo plugin_info = {
     PLUGIN_API_VERSION
 };
 
-static PluginStatus initialize(MessageCallback send_message, 
-                             BufferRequestCallback buffer_request_callback,
-                             BufferSendCallback buffer_send_callback) {
-    g_send_message = send_message;
-    g_buffer_request_callback = buffer_request_callback;
-    g_buffer_send_callback = buffer_send_callback;
-    g_bpg_decoder.reset(); // Reset decoder state on initialization
-    
-    printf("Sample Plugin Initializing...\n");
-
-    // Define paths for Python IPC
+// Deferred backend bring-up: the Python acceptor spawn/handshake and the
+// ImgSrc dlopen together take long enough to hold the app window hostage
+// when run synchronously in initialize(). They run on this thread instead;
+// g_backend_ready flips once everything is up. Until then TX forwarding
+// fails soft (send functions report an unavailable channel) and stream
+// commands are rejected with a null imgsrc_instance.
+static std::thread g_backend_init_thread;
+static std::atomic<bool> g_backend_ready{false};
+
+static void backend_init_async() {
+    // --- Python IPC Channel (Bidirectional) ---
     // TODO: Make these paths configurable or relative?
     std::string python_executable = "/Users/mdm/workspace/LittleJourney/NNLoc/.venv/bin/python";
     // Use the NEW bidirectional script
     std::string script_path = "python_bidirectional_ipc_script.py"; // Updated path relative to APP/backend
-    
-    // Initialize Python IPC Channel (Bidirectional)
-    // Pass the handle_python_data callback
     if (!init_acceptor_ipc_bidirectional(python_executable, script_path, handle_python_data)) {
-        std::cerr << "FATAL: Failed to initialize Bi-directional Python IPC channel." << std::endl;
-        return PLUGIN_ERROR_INITIALIZATION;
+        BPG_LOGE("[SamplePlugin] Failed to initialize Bi-directional Python IPC channel.");
+        return;
+    }
+    // Bounded readiness wait on the control-block flag (no blind sleeps);
+    // a late acceptor is logged but not fatal - sends fail soft until it
+    // flips the flag.
+    if (!wait_for_acceptor_ready(3000)) {
+        BPG_LOGW("[SamplePlugin] Python acceptor not ready yet; continuing startup.");
     }
-    
 
     //print CWD
-    std::cout << "Current working directory: " << getcwd(nullptr, 0) << std::endl;
+    BPG_LOGI("Current working directory: " << getcwd(nullptr, 0));
     // --- Load ImgSrc_Opencv_webcam plugin ---
     const char* plugin_path = "/Users/mdm/workspace/LittleJourney/ElectronSharedBuffer/APP/backend/build/plugins/ImgSrc_Opencv_webcam/libImgSrc_Opencv_webcam.dylib"; // adjust path as needed
     imgsrc_lib_handle = dlopen(plugin_path, RTLD_NOW);
     if (!imgsrc_lib_handle) {
-        std::cerr << "[SamplePlugin] dlopen failed: " << dlerror() << std::endl;
-        return PLUGIN_ERROR_INITIALIZATION;
+        BPG_LOGE("[SamplePlugin] dlopen failed: " << dlerror());
+        return;
     }
     auto get_itpif = reinterpret_cast<ITPIF_PluginInterface*(*)()>(dlsym(imgsrc_lib_handle, "ITPIF_GetPluginInterface"));
     if (!get_itpif) {
-        std::cerr << "[SamplePlugin] dlsym ITPIF_GetPluginInterface failed: " << dlerror() << std::endl;
-        return PLUGIN_ERROR_INITIALIZATION;
+        BPG_LOGE("[SamplePlugin] dlsym ITPIF_GetPluginInterface failed: " << dlerror());
+        return;
     }
     imgsrc_interface = get_itpif();
     if (!imgsrc_interface) {
-        std::cerr << "[SamplePlugin] ImgSrc interface is null" << std::endl;
-        return PLUGIN_ERROR_INITIALIZATION;
+        BPG_LOGE("[SamplePlugin] ImgSrc interface is null");
+        return;
     }
     // Set manager callbacks
     imgsrc_manager.dispatch = mgr_dispatch;
     imgsrc_manager.getNLockGlobalValue = mgr_getNLockGlobalValue;
     imgsrc_manager.unLockGlobalValue = mgr_unLockGlobalValue;
     imgsrc_manager.requestImg = mgr_requestImg;
+    imgsrc_manager.releaseImg = mgr_releaseImg;
     imgsrc_manager.requestStageInfo = mgr_requestStageInfo;
     // Create plugin instance
     cJSON* def = cJSON_CreateObject();
     imgsrc_instance = imgsrc_interface->create("opencv_cam", def, nullptr, &imgsrc_manager, nullptr);
     cJSON_Delete(def);
     if (!imgsrc_instance) {
-        std::cerr << "[SamplePlugin] ImgSrc create instance failed" << std::endl;
-        return PLUGIN_ERROR_INITIALIZATION;
+        BPG_LOGE("[SamplePlugin] ImgSrc create instance failed");
+        return;
     }
-    std::cout << "[SamplePlugin] Loaded ImgSrc_Opencv_webcam plugin" << std::endl;
+    BPG_LOGI("[SamplePlugin] Loaded ImgSrc_Opencv_webcam plugin");
 
-    std::cout << "Sample Plugin Initialized Successfully (with Bi-directional Python IPC)." << std::endl;
+    g_backend_ready.store(true, std::memory_order_release);
+    BPG_LOGI("Sample Plugin backend ready (Bi-directional Python IPC + ImgSrc).");
+}
+
+static PluginStatus initialize(MessageCallback send_message,
+                             BufferRequestCallback buffer_request_callback,
+                             BufferSendCallback buffer_send_callback) {
+    g_send_message = send_message;
+    g_buffer_request_callback = buffer_request_callback;
+    g_buffer_send_callback = buffer_send_callback;
+    // The relay must be up before the IPC listener can deliver responses
+    g_python_relay.start();
+    // Small-group batching in front of the transport (see SendBatcher)
+    g_send_batcher.start();
+    g_bpg_decoder.reset(); // Reset decoder state on initialization
+    // A group whose peer dies mid-transfer is released after 10s by the
+    // update() sweep instead of pinning its buffered packets forever
+    g_bpg_decoder.setGroupTimeout(10000);
+    // Catch-all route: the built-in echo/stats handler owns the whole id
+    // space until real backends carve out their ranges via registerRoute.
+    g_target_router.registerRoute(0, UINT32_MAX, "default", handle_decoded_group, 2, 64);
+
+    printf("Sample Plugin Initializing...\n");
+
+    // Everything slow (acceptor spawn, readiness handshake, ImgSrc dlopen)
+    // happens on the background thread - this returns in milliseconds.
+    g_backend_ready.store(false, std::memory_order_relaxed);
+    g_backend_init_thread = std::thread(backend_init_async);
+
+    BPG_LOGI("Sample Plugin Initialized (backend bring-up continuing in background).");
     return PLUGIN_SUCCESS;
 }
 
 static void shutdown() {
-    std::cout << "Sample plugin shutting down..." << std::endl;
+    BPG_LOGI("Sample plugin shutting down...");
+    // Let the deferred bring-up finish before tearing its results down
+    if (g_backend_init_thread.joinable()) g_backend_init_thread.join();
+    g_backend_ready.store(false, std::memory_order_relaxed);
     // Shutdown ImgSrc plugin
     if (imgsrc_interface && imgsrc_instance) {
         imgsrc_interface->destroy(imgsrc_instance);
@@ -486,35 +1314,75 @@ static void shutdown() {
     }
     // Shutdown Bi-directional Python IPC Channel
     shutdown_acceptor_ipc_bidirectional();
+    // Listener is down (no producer left) - drain and stop the relay
+    g_python_relay.stop();
+    // Drain and stop every route's worker pool
+    g_target_router.clear();
+    // No senders left - flush staged packets and stop the batcher
+    g_send_batcher.stop();
+    // Release any groups still buffered mid-transfer NOW, while the pool
+    // their pooled contents recycle into is guaranteed alive (static
+    // destruction order at unload makes no such guarantee).
+    g_bpg_decoder.reset();
     // Reset callbacks
     g_send_message = nullptr;
     g_buffer_request_callback = nullptr;
     g_buffer_send_callback = nullptr;
-    std::cout << "Sample plugin shutdown complete." << std::endl;
+    BPG_LOGI("Sample plugin shutdown complete.");
 }
 
 // Process incoming raw data from the host using the BPG decoder
 static void process_message(const uint8_t* data, size_t length) {
-    std::cout << "Sample plugin received raw data length: " << length << std::endl;
+    BPG_LOGT("Sample plugin received raw data length: " << length);
     
     // Feed data into the BPG decoder
     BPG::BpgError decode_err = g_bpg_decoder.processData(
         data, 
         length, 
-        handle_decoded_packet, // Callback for individual packets
-        handle_decoded_group   // Callback for completed groups
+        handle_decoded_packet,  // Callback for individual packets
+        dispatch_decoded_group  // Completed groups go to the worker pool
     );
-    std::cout << "processed " << std::endl;
+    BPG_LOGT("processed ");
     if (decode_err != BPG::BpgError::Success) {
-        std::cerr << "[SamplePlugin BPG] Decoder error: " << static_cast<int>(decode_err) << std::endl;
+        BPG_LOGE("[SamplePlugin BPG] Decoder error: " << static_cast<int>(decode_err));
         // Decide how to handle decoder errors (e.g., reset decoder?)
         // g_bpg_decoder.reset(); 
     }
 }
 
+// Optional API v2 hook: a host with renderer-visible shared memory offers a
+// frame ring here (after initialize). On success the frame send path above
+// switches to in-place slot writes + "FR" notifications; on failure (or
+// under a v1 host that never calls this) everything stays on the inline
+// "IM" path.
+static PluginStatus setup_frame_ring(FrameRingRequestCallback ring_request) {
+    if (!ring_request) return PLUGIN_ERROR_INITIALIZATION;
+    uint8_t* base = nullptr;
+    if (ring_request(kFrameRingSlots, kFrameRingSlotSize, &base) != 0 || base == nullptr) {
+        BPG_LOGW("[SamplePlugin] Host declined the frame ring ("
+                 << kFrameRingSlots << " x " << kFrameRingSlotSize
+                 << " bytes); frames stay inline.");
+        return PLUGIN_ERROR_INITIALIZATION;
+    }
+    if (!g_frame_ring.attach(base, kFrameRingSlots, kFrameRingSlotSize)) {
+        BPG_LOGE("[SamplePlugin] Frame ring attach failed.");
+        return PLUGIN_ERROR_INITIALIZATION;
+    }
+    BPG_LOGI("[SamplePlugin] Frame ring active: " << kFrameRingSlots
+             << " slots, " << g_frame_ring.maxFrameBytes() << " bytes/frame.");
+    return PLUGIN_SUCCESS;
+}
+
 static void update() {
-    // Called periodically by the host
-    // Could potentially check for timeouts on incomplete BPG groups here if needed
+    // Called periodically by the host: age out incomplete BPG groups. The
+    // sweep walks only the timer-wheel slices elapsed since the last call,
+    // so an idle tick is a few empty bucket checks.
+    size_t expired = g_bpg_decoder.sweepExpiredGroups();
+    if (expired > 0) {
+        BPG_LOGW("[SamplePlugin BPG] Timed out " << expired
+                 << " incomplete group(s) (total "
+                 << g_bpg_decoder.timedOutGroupCount() << ").");
+    }
 }
 
 // Plugin interface instance
@@ -523,7 +1391,8 @@ static PluginInterface plugin_interface = {
     initialize,
     shutdown,
     process_message,
-    update
+    update,
+    setup_frame_ring
 };
 
 // Plugin entry point
@@ -0,0 +1,352 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include <cstring>
+#include <chrono>
+#include <algorithm>
+#include <iomanip>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <ctime>
+#include "../python_ipc.h"
+
+// POSIX: the soak watchdog maps the SHM control block read-only by name
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+// --- Shared-memory IPC round-trip benchmark + soak ---
+// Drives init_acceptor_ipc_bidirectional / send_data_to_acceptor_async against
+// the echo Acceptor (tests/ipc_echo_acceptor.py) and reports, per payload
+// size, serial round-trip latency percentiles (p50/p95/p99/max) and the
+// sustained message rate with the full ring depth in flight. '--soak N' then
+// runs for N minutes (hours are the intended use) watching for the production
+// stall signature: c_to_a_command stuck nonzero and sends timing out.
+//
+// NOTE: init_acceptor_ipc_bidirectional resolves the script path as
+// "APP/backend/<script>" relative to the working directory (the production
+// layout) - run from a directory where that resolves, or pass a path argument
+// that does.
+
+using Clock = std::chrono::steady_clock;
+
+// --- Response rendezvous (the data callback runs on the listener thread) ---
+static std::mutex g_resp_mutex;
+static std::condition_variable g_resp_cv;
+static uint64_t g_responses_received = 0;
+static size_t g_last_response_len = 0;
+static uint8_t g_last_response_first = 0;
+static std::atomic<uint64_t> g_bad_echoes{0};
+
+static void response_callback(uint32_t /*group_id*/, uint32_t /*target_id*/,
+                              const uint8_t* data, size_t length) {
+    std::lock_guard<std::mutex> lock(g_resp_mutex);
+    ++g_responses_received;
+    g_last_response_len = length;
+    g_last_response_first = (length > 0 && data) ? data[0] : 0;
+    g_resp_cv.notify_all();
+}
+
+// Blocks until 'target' responses have arrived in total. Returns false on timeout.
+static bool wait_for_responses(uint64_t target, int timeout_ms) {
+    std::unique_lock<std::mutex> lock(g_resp_mutex);
+    return g_resp_cv.wait_for(lock, std::chrono::milliseconds(timeout_ms),
+                              [&] { return g_responses_received >= target; });
+}
+
+struct LatencyStats {
+    double p50_us;
+    double p95_us;
+    double p99_us;
+    double max_us;
+};
+
+static LatencyStats computeStats(std::vector<double>& samples_us) {
+    LatencyStats s{0, 0, 0, 0};
+    if (samples_us.empty()) return s;
+    std::sort(samples_us.begin(), samples_us.end());
+    auto at = [&](size_t pct) {
+        return samples_us[std::min(samples_us.size() - 1, (samples_us.size() * pct) / 100)];
+    };
+    s.p50_us = at(50);
+    s.p95_us = at(95);
+    s.p99_us = at(99);
+    s.max_us = samples_us.back();
+    return s;
+}
+
+// Serial ping-pong: one message in flight, each round trip is one sample.
+// Returns false if a send fails or a response never arrives.
+static bool runLatencyPass(const std::vector<uint8_t>& payload, size_t iterations,
+                           std::vector<double>& samples_us) {
+    samples_us.clear();
+    samples_us.reserve(iterations);
+    for (size_t i = 0; i < iterations; ++i) {
+        uint64_t expected;
+        {
+            std::lock_guard<std::mutex> lock(g_resp_mutex);
+            expected = g_responses_received + 1;
+        }
+        auto t0 = Clock::now();
+        if (!send_data_to_acceptor_async(payload.data(), payload.size())) {
+            std::cerr << "Send failed at iteration " << i << " (payload "
+                      << payload.size() << "B)." << std::endl;
+            return false;
+        }
+        if (!wait_for_responses(expected, 5000)) {
+            std::cerr << "Response timeout at iteration " << i << " (payload "
+                      << payload.size() << "B)." << std::endl;
+            return false;
+        }
+        auto t1 = Clock::now();
+        samples_us.push_back(std::chrono::duration<double, std::micro>(t1 - t0).count());
+        {
+            std::lock_guard<std::mutex> lock(g_resp_mutex);
+            if (g_last_response_len != payload.size() ||
+                (payload.size() > 0 && g_last_response_first != payload[0])) {
+                g_bad_echoes.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+    }
+    return true;
+}
+
+// Pipelined: keep sending for 'duration' with the ring as the only back
+// pressure (send_data blocks when all SHM_RING_SLOT_COUNT slots are in
+// flight), then drain. Returns completed round trips.
+static uint64_t runThroughputPass(const std::vector<uint8_t>& payload,
+                                  std::chrono::milliseconds duration,
+                                  double& out_seconds) {
+    uint64_t start_responses;
+    {
+        std::lock_guard<std::mutex> lock(g_resp_mutex);
+        start_responses = g_responses_received;
+    }
+    uint64_t sent = 0;
+    auto t0 = Clock::now();
+    while (Clock::now() - t0 < duration) {
+        if (!send_data_to_acceptor_async(payload.data(), payload.size())) break;
+        ++sent;
+    }
+    wait_for_responses(start_responses + sent, 5000);
+    out_seconds = std::chrono::duration<double>(Clock::now() - t0).count();
+    uint64_t completed;
+    {
+        std::lock_guard<std::mutex> lock(g_resp_mutex);
+        completed = g_responses_received - start_responses;
+    }
+    return completed;
+}
+
+// --- Soak mode ---
+// A second read-only mapping of the control block (by name, independent of
+// python_ipc.cc's private pointer) lets the watchdog observe c_to_a_command
+// exactly the way an outside debugger would.
+static const SharedIPCBidirectional* map_control_block_readonly() {
+    int fd = shm_open(SHM_NAME_BI, O_RDONLY, 0);
+    if (fd == -1) return nullptr;
+    void* ptr = mmap(nullptr, sizeof(SharedIPCBidirectional), PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    return (ptr == MAP_FAILED) ? nullptr : static_cast<const SharedIPCBidirectional*>(ptr);
+}
+
+static std::string timestamp() {
+    auto now = std::chrono::system_clock::now();
+    std::time_t t = std::chrono::system_clock::to_time_t(now);
+    char buf[32];
+    std::strftime(buf, sizeof(buf), "%H:%M:%S", std::localtime(&t));
+    return buf;
+}
+
+static int runSoak(int minutes, const std::vector<std::vector<uint8_t>>& payloads) {
+    const SharedIPCBidirectional* ctrl = map_control_block_readonly();
+    if (!ctrl) {
+        std::cerr << "Soak: could not map control block read-only; "
+                     "command-flag watchdog disabled." << std::endl;
+    }
+
+    uint64_t round_trips = 0;
+    uint64_t send_failures = 0;
+    uint64_t response_timeouts = 0;
+    uint64_t command_stalls = 0;
+    Clock::time_point command_nonzero_since{};
+    bool command_stall_reported = false;
+    double worst_rtt_us = 0;
+
+    auto deadline = Clock::now() + std::chrono::minutes(minutes);
+    auto next_progress = Clock::now() + std::chrono::minutes(5);
+    size_t size_index = 0;
+
+    std::cout << "Soak: running for " << minutes << " minute(s), rotating "
+              << payloads.size() << " payload sizes..." << std::endl;
+
+    while (Clock::now() < deadline) {
+        const std::vector<uint8_t>& payload = payloads[size_index];
+        size_index = (size_index + 1) % payloads.size();
+
+        uint64_t expected;
+        {
+            std::lock_guard<std::mutex> lock(g_resp_mutex);
+            expected = g_responses_received + 1;
+        }
+        auto t0 = Clock::now();
+        if (!send_data_to_acceptor_async(payload.data(), payload.size())) {
+            ++send_failures;
+            std::cout << "[" << timestamp() << "] SEND TIMEOUT/FAILURE #" << send_failures
+                      << " (payload " << payload.size() << "B, after "
+                      << round_trips << " round trips)" << std::endl;
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        } else if (!wait_for_responses(expected, 10000)) {
+            ++response_timeouts;
+            std::cout << "[" << timestamp() << "] RESPONSE TIMEOUT #" << response_timeouts
+                      << " (payload " << payload.size() << "B, after "
+                      << round_trips << " round trips)" << std::endl;
+        } else {
+            ++round_trips;
+            worst_rtt_us = std::max(worst_rtt_us,
+                std::chrono::duration<double, std::micro>(Clock::now() - t0).count());
+        }
+
+        // --- Command-flag watchdog: outside shutdown, c_to_a_command must be
+        // 0. Stuck nonzero for >1s is the production stall signature. ---
+        if (ctrl) {
+            if (ctrl->c_to_a_command.load(std::memory_order_relaxed) != 0) {
+                if (command_nonzero_since == Clock::time_point{}) {
+                    command_nonzero_since = Clock::now();
+                } else if (!command_stall_reported &&
+                           Clock::now() - command_nonzero_since > std::chrono::seconds(1)) {
+                    ++command_stalls;
+                    command_stall_reported = true;
+                    std::cout << "[" << timestamp() << "] COMMAND STALL #" << command_stalls
+                              << ": c_to_a_command="
+                              << ctrl->c_to_a_command.load(std::memory_order_relaxed)
+                              << " for >1s (after " << round_trips << " round trips)"
+                              << std::endl;
+                }
+            } else {
+                command_nonzero_since = Clock::time_point{};
+                command_stall_reported = false;
+            }
+        }
+
+        if (Clock::now() >= next_progress) {
+            next_progress += std::chrono::minutes(5);
+            std::cout << "[" << timestamp() << "] soak progress: " << round_trips
+                      << " round trips, " << send_failures << " send failures, "
+                      << response_timeouts << " response timeouts, "
+                      << command_stalls << " command stalls, worst RTT "
+                      << std::fixed << std::setprecision(1) << worst_rtt_us << "us"
+                      << std::endl;
+        }
+    }
+
+    std::cout << "\nSoak summary:" << std::endl
+              << "  round trips:       " << round_trips << std::endl
+              << "  send failures:     " << send_failures << std::endl
+              << "  response timeouts: " << response_timeouts << std::endl
+              << "  command stalls:    " << command_stalls << std::endl
+              << "  bad echoes:        " << g_bad_echoes.load() << std::endl
+              << "  worst RTT:         " << std::fixed << std::setprecision(1)
+              << worst_rtt_us << "us" << std::endl;
+    return (send_failures || response_timeouts || command_stalls || g_bad_echoes.load()) ? 1 : 0;
+}
+
+int main(int argc, char** argv) {
+    std::string python_exe = "python3";
+    std::string script_path = "tests/ipc_echo_acceptor.py";
+    int soak_minutes = 0;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--soak" && i + 1 < argc) {
+            soak_minutes = std::atoi(argv[++i]);
+        } else if (arg == "--python" && i + 1 < argc) {
+            python_exe = argv[++i];
+        } else if (arg == "--script" && i + 1 < argc) {
+            script_path = argv[++i];
+        } else {
+            std::cerr << "Usage: " << argv[0]
+                      << " [--python <exe>] [--script <path>] [--soak <minutes>]\n"
+                         "The script path is resolved as APP/backend/<path> relative\n"
+                         "to the working directory (see init_acceptor_ipc_bidirectional)."
+                      << std::endl;
+            return 2;
+        }
+    }
+
+    // Payload sweep. The header has no hard per-direction maximum constant -
+    // the ceiling is the per-slot size chosen at init minus the 4-byte request
+    // id - so both directions are sized to the A2C default (2MB) and the
+    // sweep tops out just under one slot.
+    const size_t slot_size = SHM_A2C_BUFFER_DEFAULT_SIZE;
+    const size_t max_payload = slot_size - IPC_REQUEST_ID_SIZE;
+    const size_t payload_sizes[] = {
+        64, 1024, 16 * 1024, 256 * 1024, 1024 * 1024, max_payload
+    };
+
+    if (!init_acceptor_ipc_bidirectional(python_exe, script_path, response_callback,
+                                         slot_size, slot_size)) {
+        std::cerr << "IPC init failed." << std::endl;
+        return 1;
+    }
+    if (!wait_for_acceptor_ready(5000)) {
+        std::cerr << "Echo Acceptor did not come up within 5s (is the script path "
+                     "reachable as APP/backend/" << script_path << "?)." << std::endl;
+        shutdown_acceptor_ipc_bidirectional();
+        return 1;
+    }
+
+    int rc = 0;
+    if (soak_minutes > 0) {
+        std::vector<std::vector<uint8_t>> payloads;
+        for (size_t size : payload_sizes) {
+            payloads.emplace_back(size, static_cast<uint8_t>(size & 0xFF));
+        }
+        rc = runSoak(soak_minutes, payloads);
+    } else {
+        std::cout << std::left
+                  << std::setw(10) << "payload"
+                  << std::setw(11) << "p50 us"
+                  << std::setw(11) << "p95 us"
+                  << std::setw(11) << "p99 us"
+                  << std::setw(11) << "max us"
+                  << std::setw(11) << "msgs/s"
+                  << std::setw(11) << "MB/s"
+                  << std::endl;
+
+        std::vector<double> samples;
+        for (size_t size : payload_sizes) {
+            std::vector<uint8_t> payload(size, static_cast<uint8_t>(size & 0xFF));
+            // Fewer serial iterations for the multi-MB sizes; enough for p99
+            size_t iterations = (size >= 1024 * 1024) ? 300 : 1000;
+
+            runLatencyPass(payload, 8, samples); // Warmup (page faults, caches)
+            if (!runLatencyPass(payload, iterations, samples)) { rc = 1; break; }
+            LatencyStats lat = computeStats(samples);
+
+            double seconds = 0;
+            uint64_t completed = runThroughputPass(payload, std::chrono::milliseconds(2000), seconds);
+            double msgs_per_sec = (seconds > 0) ? completed / seconds : 0;
+
+            std::cout << std::left << std::fixed << std::setprecision(1)
+                      << std::setw(10) << size
+                      << std::setw(11) << lat.p50_us
+                      << std::setw(11) << lat.p95_us
+                      << std::setw(11) << lat.p99_us
+                      << std::setw(11) << lat.max_us
+                      << std::setw(11) << std::setprecision(0) << msgs_per_sec
+                      << std::setw(11) << std::setprecision(1)
+                      << (msgs_per_sec * size) / 1e6
+                      << std::endl;
+        }
+        if (g_bad_echoes.load() != 0) {
+            std::cerr << "VERIFY FAILED: " << g_bad_echoes.load()
+                      << " responses did not match the sent payload." << std::endl;
+            rc = 1;
+        }
+    }
+
+    shutdown_acceptor_ipc_bidirectional();
+    return rc;
+}
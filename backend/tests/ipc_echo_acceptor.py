@@ -0,0 +1,210 @@
+# backend/tests/ipc_echo_acceptor.py
+#
+# Minimal echo Acceptor for the ipc_benchmark executable. It speaks the same
+# shared-memory protocol as python_bidirectional_ipc_script.py (control block,
+# rings, doorbells, readiness flag) but echoes every C->A message back
+# verbatim - request id prefix included - with no per-message prints, numpy or
+# cv2, so the benchmark measures the channel itself and not the example
+# processing. Keep the ctypes layout below in sync with python_ipc.h.
+import sys
+import time
+import ctypes
+import mmap
+import os
+import signal
+import platform
+
+O_RDWR = os.O_RDWR
+DEFAULT_SHM_MODE = 0o666
+
+libc = ctypes.CDLL(None)
+c_shm_open = libc.shm_open
+c_shm_open.argtypes = [ctypes.c_char_p, ctypes.c_int, ctypes.c_int]
+c_shm_open.restype = ctypes.c_int
+c_close = libc.close
+c_close.argtypes = [ctypes.c_int]
+c_close.restype = ctypes.c_int
+
+# Must match SHM_RING_SLOT_COUNT in python_ipc.h
+SHM_RING_SLOT_COUNT = 8
+
+
+class ShmMsgRing(ctypes.Structure):
+    _fields_ = [
+        ("head", ctypes.c_uint64),
+        ("tail", ctypes.c_uint64),
+        ("slot_len", ctypes.c_uint64 * SHM_RING_SLOT_COUNT),
+        ("data_doorbell", ctypes.c_uint32),
+        ("space_doorbell", ctypes.c_uint32),
+    ]
+
+
+class SharedIPCBidirectional(ctypes.Structure):
+    _fields_ = [
+        ("c_to_a_command", ctypes.c_int32),
+        ("a_to_c_status", ctypes.c_int32),
+        ("acceptor_ready", ctypes.c_int32),
+        ("_reserved0", ctypes.c_int32),
+        ("defined_c2a_buffer_size", ctypes.c_size_t),
+        ("defined_a2c_buffer_size", ctypes.c_size_t),
+        ("ring_slot_count", ctypes.c_uint64),
+        ("c2a_ring", ShmMsgRing),
+        ("a2c_ring", ShmMsgRing),
+        ("_padding1", ctypes.c_char * (256
+                                       - ctypes.sizeof(ctypes.c_int32)*4
+                                       - ctypes.sizeof(ctypes.c_size_t)*2
+                                       - ctypes.sizeof(ctypes.c_uint64)
+                                       - ctypes.sizeof(ShmMsgRing)*2)),
+    ]
+
+
+SHM_CONTROL_BLOCK_SIZE = ctypes.sizeof(SharedIPCBidirectional)
+
+# --- Futex wakeup (Linux; elsewhere fall back to short sleeps) ---
+FUTEX_WAIT = 0
+FUTEX_WAKE = 1
+_SYS_FUTEX = {"x86_64": 202, "aarch64": 98, "arm64": 98}.get(platform.machine()) \
+    if sys.platform.startswith("linux") else None
+
+
+class _timespec(ctypes.Structure):
+    _fields_ = [("tv_sec", ctypes.c_long), ("tv_nsec", ctypes.c_long)]
+
+
+# Typed prototype so the 64-bit doorbell address is not truncated to c_int
+# (see the matching comment in python_bidirectional_ipc_script.py)
+_c_futex = libc.syscall
+_c_futex.restype = ctypes.c_long
+_c_futex.argtypes = [ctypes.c_long, ctypes.c_void_p, ctypes.c_int,
+                     ctypes.c_uint32, ctypes.c_void_p, ctypes.c_void_p,
+                     ctypes.c_uint32]
+
+
+def doorbell_addr(ring, field_name):
+    return ctypes.addressof(ring) + getattr(type(ring), field_name).offset
+
+
+def doorbell_wait(ring, field_name, seen_value, timeout_s):
+    if _SYS_FUTEX is None:
+        time.sleep(min(timeout_s, 0.0005))
+        return
+    ts = _timespec(int(timeout_s), int((timeout_s % 1.0) * 1e9))
+    _c_futex(_SYS_FUTEX, doorbell_addr(ring, field_name), FUTEX_WAIT,
+             seen_value, ctypes.byref(ts), None, 0)
+
+
+def doorbell_ring(ring, field_name):
+    setattr(ring, field_name, (getattr(ring, field_name) + 1) & 0xFFFFFFFF)
+    if _SYS_FUTEX is not None:
+        _c_futex(_SYS_FUTEX, doorbell_addr(ring, field_name), FUTEX_WAKE,
+                 0x7FFFFFFF, None, None, 0)
+
+
+running = True
+
+
+def signal_handler(sig, frame):
+    global running
+    running = False
+
+
+def main_loop(shm_name):
+    global running
+    print(f"[IPC Echo Acceptor] Started. PID: {os.getpid()}, SHM: {shm_name}")
+
+    shm_fd = -1
+    encoded_name = shm_name.encode("utf-8")
+    attach_delay = 0.1
+    for attempt in range(5):
+        shm_fd = c_shm_open(encoded_name, O_RDWR, DEFAULT_SHM_MODE)
+        if shm_fd != -1:
+            break
+        if attempt == 4:
+            print(f"[IPC Echo Acceptor] Error: shm_open('{shm_name}') failed. Exiting.")
+            sys.exit(1)
+        time.sleep(attach_delay)
+        attach_delay *= 1.5
+
+    shm_size = os.fstat(shm_fd).st_size
+    mmap_obj = mmap.mmap(shm_fd, shm_size, access=mmap.ACCESS_WRITE, flags=mmap.MAP_SHARED)
+    shm = SharedIPCBidirectional.from_buffer(mmap_obj)
+
+    c2a_size = shm.defined_c2a_buffer_size
+    a2c_size = shm.defined_a2c_buffer_size
+    if c2a_size <= 0 or a2c_size <= 0 or shm.ring_slot_count != SHM_RING_SLOT_COUNT:
+        print(f"[IPC Echo Acceptor] Error: Bad layout in SHM (c2a={c2a_size}, "
+              f"a2c={a2c_size}, slots={shm.ring_slot_count}). Exiting.")
+        sys.exit(1)
+    print(f"[IPC Echo Acceptor] Layout: C2A={c2a_size}, A2C={a2c_size} per slot.")
+
+    signal.signal(signal.SIGINT, signal_handler)
+    signal.signal(signal.SIGTERM, signal_handler)
+
+    # Segment mapped and layout validated - unblock wait_for_acceptor_ready()
+    shm.acceptor_ready = 1
+
+    echoed = 0
+    try:
+        while running:
+            if shm.c_to_a_command == 99:
+                shm.c_to_a_command = 0
+                break
+
+            c2a = shm.c2a_ring
+            a2c = shm.a2c_ring
+            doorbell_seen = c2a.data_doorbell
+            if c2a.head == c2a.tail:
+                doorbell_wait(c2a, "data_doorbell", doorbell_seen, 0.1)
+                continue
+
+            while c2a.tail != c2a.head and running:
+                tail = c2a.tail
+                slot = tail % SHM_RING_SLOT_COUNT
+                data_len = c2a.slot_len[slot]
+                src_off = SHM_CONTROL_BLOCK_SIZE + slot * c2a_size
+                data = mmap_obj[src_off:src_off + min(data_len, c2a_size)]
+                # Release the C2A slot before publishing the echo so the
+                # benchmark can keep the full ring depth in flight
+                c2a.tail = tail + 1
+                doorbell_ring(c2a, "space_doorbell")
+
+                if len(data) > a2c_size:
+                    shm.a_to_c_status = -1
+                    continue
+
+                # Wait only when ALL A2C slots are in flight
+                start = time.time()
+                while True:
+                    space_seen = a2c.space_doorbell
+                    if a2c.head - a2c.tail < SHM_RING_SLOT_COUNT:
+                        break
+                    if not running or time.time() - start > 5.0:
+                        break
+                    doorbell_wait(a2c, "space_doorbell", space_seen, 0.1)
+                if a2c.head - a2c.tail >= SHM_RING_SLOT_COUNT:
+                    continue  # Timed out; drop rather than block the drain
+
+                head = a2c.head
+                out_slot = head % SHM_RING_SLOT_COUNT
+                dst_off = (SHM_CONTROL_BLOCK_SIZE
+                           + SHM_RING_SLOT_COUNT * c2a_size
+                           + out_slot * a2c_size)
+                mmap_obj[dst_off:dst_off + len(data)] = data
+                a2c.slot_len[out_slot] = len(data)
+                a2c.head = head + 1
+                doorbell_ring(a2c, "data_doorbell")
+                echoed += 1
+    finally:
+        print(f"[IPC Echo Acceptor] Exiting after {echoed} echoed messages.")
+        try:
+            mmap_obj.close()
+        except BufferError:
+            pass  # ctypes views into the mapping still referenced; process exit unmaps
+        c_close(shm_fd)
+
+
+if __name__ == "__main__":
+    if len(sys.argv) != 2:
+        print(f"Usage: python {sys.argv[0]} <shm_name>")
+        sys.exit(1)
+    main_loop(sys.argv[1])
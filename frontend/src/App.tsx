@@ -2,7 +2,7 @@ import React, { useEffect, useState, useRef, useCallback } from 'react';
 import { SharedMemoryChannel } from './lib/SharedMemoryChannel';
 import { nativeAddon } from './lib/nativeAddon';
 // Import BPG Types needed for the App component
-import { AppPacket, AppPacketGroup } from './lib/BPG_Protocol';
+import { AppPacket, AppPacketGroup, decodeTlvMetadata } from './lib/BPG_Protocol';
 // Import the custom hook
 import { useBPGProtocol, BPGPacketDescriptor, UseBPGProtocolOptions } from './hooks/useBPGProtocol';
 import './App.css';
@@ -349,6 +349,7 @@ function App() {
              let isImagePacket = false; // Flag to check if we handled this as an image
              let contentPreview = `Resp TL:${packet.tl}, EG:${packet.is_end_of_group ? 'Y' : 'N'}, TID:${packet.target_id}`;
              if (packet.content.metadata_str) contentPreview += `, Meta: ${packet.content.metadata_str.substring(0, 30)}...`;
+             else if (packet.content.metadata_is_tlv && packet.content.metadata_bytes) contentPreview += `, Meta: TLV (${packet.content.metadata_bytes.length}B)`;
              if (packet.content.binary_bytes.length > 0) {
                  contentPreview += `, Bin Size: ${packet.content.binary_bytes.length}`;
                  // Use the new helper function for hex preview
@@ -360,9 +361,13 @@ function App() {
              }
 
              // --- Handle "IM" packets ---
-             if (packet.tl === 'IM' && packet.content.metadata_str && packet.content.binary_bytes.length > 0) {
+             if (packet.tl === 'IM' && (packet.content.metadata_str || packet.content.metadata_is_tlv) && packet.content.binary_bytes.length > 0) {
                  try {
-                     const metadata = JSON.parse(packet.content.metadata_str);
+                     // Hot-path IM metadata arrives as binary TLV (no JSON
+                     // parse); JSON remains the fallback for older senders.
+                     const metadata: any = packet.content.metadata_is_tlv && packet.content.metadata_bytes
+                         ? decodeTlvMetadata(packet.content.metadata_bytes)
+                         : JSON.parse(packet.content.metadata_str);
                      if (metadata.format === 'raw_rgba' && metadata.width > 0 && metadata.height > 0) {
                          const width = metadata.width;
                          const height = metadata.height;
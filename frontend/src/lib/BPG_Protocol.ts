@@ -7,8 +7,14 @@ export interface PacketHeader {
 }
 
 export interface HybridData {
-    metadata_str: string; 
+    metadata_str: string;
     binary_bytes: Uint8Array;
+    // Binary TLV metadata sidecar (mirrors the C++ side's tlv_metadata.h):
+    // when metadata_is_tlv is set the metadata bytes are tagged binary
+    // fields (see decodeTlvMetadata) instead of a JSON string, flagged on
+    // the wire via a prop bit. metadata_str stays empty in that case.
+    metadata_is_tlv?: boolean;
+    metadata_bytes?: Uint8Array;
 }
 
 export interface AppPacket {
@@ -27,15 +33,68 @@ export type GroupCallback = (groupId: number, group: AppPacketGroup) => void;
 // Constants
 export const HEADER_SIZE = 18; // Updated Size
 const PROP_EG_BIT_MASK = 0x00000001;
+const PROP_TLV_META_BIT_MASK = 0x00000002; // Metadata bytes are TLV, not JSON
 const STR_LENGTH_SIZE = 4; // Renamed from JSON_LENGTH_SIZE for clarity
 
+// --- TLV metadata ---
+// Field = tag(1) + value. Tags with the high bit clear carry a 4-byte
+// big-endian uint32; tags with the high bit set carry a 1-byte length
+// followed by that many bytes (unknown tags are skippable either way).
+// Keys mirror the C++ TlvKey enum.
+const TLV_STRING_TAG_BIT = 0x80;
+const TLV_KEY_NAMES: { [tag: number]: string } = {
+    0x01: 'width',
+    0x02: 'height',
+    0x03: 'channels',
+    0x04: 'type',        // cv::Mat type() value
+    0x05: 'request_id',
+    0x06: 'slot',        // frame-ring slot index (see FrameRing.ts)
+    0x07: 'generation',  // frame-ring slot generation
+    0x81: 'format',
+};
+
+// Decodes TLV metadata bytes into the same shape the old JSON metadata
+// parsed to ({width, height, format, ...}), so IM consumers need no DOM
+// parse on the 30fps image path. Unknown tags are skipped.
+export function decodeTlvMetadata(bytes: Uint8Array): { [key: string]: number | string } {
+    const result: { [key: string]: number | string } = {};
+    const view = new DataView(bytes.buffer, bytes.byteOffset, bytes.byteLength);
+    let pos = 0;
+    while (pos < bytes.length) {
+        const tag = bytes[pos];
+        let value: number | string;
+        let fieldSize: number;
+        if (tag & TLV_STRING_TAG_BIT) {
+            if (pos + 2 > bytes.length) break;
+            const len = bytes[pos + 1];
+            fieldSize = 2 + len;
+            if (pos + fieldSize > bytes.length) break;
+            value = new TextDecoder().decode(bytes.subarray(pos + 2, pos + 2 + len));
+        } else {
+            fieldSize = 5;
+            if (pos + fieldSize > bytes.length) break;
+            value = view.getUint32(pos + 1, false);
+        }
+        const name = TLV_KEY_NAMES[tag];
+        if (name !== undefined) result[name] = value;
+        pos += fieldSize;
+    }
+    return result;
+}
+
 // --- Encoder --- 
 
 export class BpgEncoder {
 
+    // Metadata bytes on the wire: the TLV sidecar when flagged, else the
+    // UTF-8 encoded JSON string.
+    private metadataBytes(data: HybridData): Uint8Array {
+        if (data.metadata_is_tlv && data.metadata_bytes) return data.metadata_bytes;
+        return new TextEncoder().encode(data.metadata_str);
+    }
+
     private calculateHybridDataSize(data: HybridData): number {
-        const strBytes = new TextEncoder().encode(data.metadata_str); 
-        return STR_LENGTH_SIZE + strBytes.length + data.binary_bytes.length;
+        return STR_LENGTH_SIZE + this.metadataBytes(data).length + data.binary_bytes.length;
     }
 
     encodePacket(packet: AppPacket): Uint8Array {
@@ -54,9 +113,12 @@ export class BpgEncoder {
         // Prop (4 bytes, Big Endian)
         let propValue = 0;
         if (packet.is_end_of_group) {
-            propValue |= PROP_EG_BIT_MASK; 
+            propValue |= PROP_EG_BIT_MASK;
         }
-        dataView.setUint32(offset, propValue, false); 
+        if (packet.content.metadata_is_tlv) {
+            propValue |= PROP_TLV_META_BIT_MASK;
+        }
+        dataView.setUint32(offset, propValue, false);
         offset += 4;
 
         // Target ID (4 bytes, Big Endian)
@@ -72,7 +134,7 @@ export class BpgEncoder {
         offset += 4;
         
         // --- Data (HybridData) ---
-        const strBytes = new TextEncoder().encode(packet.content.metadata_str); 
+        const strBytes = this.metadataBytes(packet.content);
         const strLength = strBytes.length;
         
         // String Length 
@@ -154,6 +216,7 @@ export class BpgDecoder {
 
             // Check EG Bit from prop field LSB
             const isEndOfGroup = (propValue & PROP_EG_BIT_MASK) !== 0;
+            const metadataIsTlv = (propValue & PROP_TLV_META_BIT_MASK) !== 0;
 
             // --- Deserialize HybridData ---
             const hybridData: HybridData = { metadata_str: "", binary_bytes: new Uint8Array(0) };
@@ -174,11 +237,18 @@ export class BpgDecoder {
                    continue; 
             }
 
-            // Metadata String
+            // Metadata: raw TLV bytes when flagged in prop (decode on demand
+            // via decodeTlvMetadata - no parse unless the consumer asks),
+            // else a UTF-8 JSON string as before.
             if (strLength > 0) {
                  if(dataOffset + strLength > totalPacketSize) { console.error("Incomplete metadata"); break; }
                 const strBytes = this.internal_buffer.slice(dataOffset, dataOffset + strLength);
-                hybridData.metadata_str = new TextDecoder().decode(strBytes); 
+                if (metadataIsTlv) {
+                    hybridData.metadata_is_tlv = true;
+                    hybridData.metadata_bytes = strBytes;
+                } else {
+                    hybridData.metadata_str = new TextDecoder().decode(strBytes);
+                }
                 dataOffset += strLength;
             }
 
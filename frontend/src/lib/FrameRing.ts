@@ -0,0 +1,71 @@
+// --- Shared frame ring (renderer-side reader) ---
+// Mirrors backend/frame_ring.h: the native plugin writes each new frame
+// in place into one of N fixed slots of shared memory and announces it
+// with a tiny "FR" BPG packet whose TLV metadata carries (slot,
+// generation). This reader resolves such a notification against the ring.
+//
+// Each slot = 32-byte header + pixel bytes. header.generation is a
+// seqlock: odd while the writer is in the slot, bumped to the next even
+// value when the frame is complete. A read is valid only if the
+// generation is even, matches the notified value, and is unchanged after
+// the pixels were copied - anything else means the slot was overwritten
+// (the notification is stale; skipping it is the point of the ring) or
+// the copy raced the writer.
+
+export const SLOT_HEADER_SIZE = 32;
+
+// Uint32 indices into the slot header
+const HDR_GENERATION = 0;
+const HDR_WIDTH = 1;
+const HDR_HEIGHT = 2;
+const HDR_PIXEL_TYPE = 3;
+const HDR_DATA_SIZE = 4;
+
+export interface FrameView {
+    width: number;
+    height: number;
+    pixelType: number;   // cv::Mat type() value of the pixels
+    generation: number;
+    pixels: Uint8Array;  // Copied out of the slot (stable after return)
+}
+
+export class FrameRingReader {
+    private buffer: ArrayBufferLike;
+    private baseOffset: number;
+    private slotCount: number;
+    private slotSize: number;
+
+    constructor(buffer: ArrayBufferLike, baseOffset: number, slotCount: number, slotSize: number) {
+        this.buffer = buffer;
+        this.baseOffset = baseOffset;
+        this.slotCount = slotCount;
+        this.slotSize = slotSize;
+    }
+
+    // Resolves an FR notification. Returns null when the slot has already
+    // been overwritten (stale generation) or the read tore - the caller
+    // simply drops that frame and waits for the next notification.
+    readFrame(slot: number, generation: number): FrameView | null {
+        if (slot >= this.slotCount) return null;
+        const slotOffset = this.baseOffset + slot * this.slotSize;
+        const header = new Uint32Array(this.buffer, slotOffset, SLOT_HEADER_SIZE / 4);
+
+        const genBefore = Atomics.load(header, HDR_GENERATION);
+        if (genBefore !== generation || (genBefore & 1) !== 0) return null;
+
+        const width = header[HDR_WIDTH];
+        const height = header[HDR_HEIGHT];
+        const pixelType = header[HDR_PIXEL_TYPE];
+        const dataSize = header[HDR_DATA_SIZE];
+        if (dataSize > this.slotSize - SLOT_HEADER_SIZE) return null;
+
+        const pixels = new Uint8Array(dataSize);
+        pixels.set(new Uint8Array(this.buffer, slotOffset + SLOT_HEADER_SIZE, dataSize));
+
+        // Torn-read check: the writer bumps the generation before touching
+        // the slot, so an unchanged value proves the copy saw one frame.
+        if (Atomics.load(header, HDR_GENERATION) !== genBefore) return null;
+
+        return { width, height, pixelType, generation: genBefore, pixels };
+    }
+}